@@ -19,11 +19,13 @@
 ////////////////////////////////////////////////////////////////////////////
 
 #include "Support/TBool.h"
+#include "Support/LandmarkSet.h"
 #include "llvm/Value.h"
 #include "llvm/Constants.h"
 #include "llvm/Type.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Debug.h"
 
@@ -36,6 +38,15 @@ namespace unimelb {
     WrappedRangeId        = 1  //!< wrapped range analysis.
   } BaseId ;
 
+  /// Memory for an abstract value of class T. It comes from Arena if
+  /// not NULL or from the heap otherwise (and then it can be deleted).
+  template<typename T>
+  inline void* allocateAbsVal(BumpPtrAllocator *Arena){
+    if (Arena)
+      return Arena->Allocate<T>();
+    return ::operator new(sizeof(T));
+  }
+
   /// Class that represents an abstract value.
   class AbstractValue {
   protected: 
@@ -53,7 +64,7 @@ namespace unimelb {
       var(v), numOfChanges(0), B(NULL), IsLattice(isLattice){}   
     /// Constructor of the class. Only for temporary computations.
     AbstractValue(bool isLattice = true): 
-      var(NULL), numOfChanges(0), IsLattice(isLattice){}       
+      var(NULL), numOfChanges(0), B(NULL), IsLattice(isLattice){}       
     /// Copy constructor of the class
     AbstractValue(const AbstractValue&  other) {
       var          = other.var;
@@ -63,8 +74,22 @@ namespace unimelb {
     }
     /// Make a clone of the abstract value
     virtual AbstractValue* clone() = 0;  
+    /// Make a clone of the abstract value in Arena. It must not be
+    /// deleted but destroyed (see destroy) before Arena is reset.
+    virtual AbstractValue* clone(BumpPtrAllocator &Arena) = 0;  
+    /// Overwrite this with the contents of V without allocating
+    /// memory. V must be of the same class than this.
+    virtual void assign(AbstractValue *V){
+      var          = V->var;
+      numOfChanges = V->numOfChanges;
+      B            = V->B;
+      IsLattice    = V->IsLattice;
+    }
     /// Destructor of the class
     virtual ~AbstractValue(){}
+    /// Run the destructor of a value allocated in an arena without
+    /// freeing its memory.
+    inline void destroy(){ this->~AbstractValue(); }
 
     /// Return the number of times the variable has changed.
     inline unsigned  getNumOfChanges(){ return numOfChanges; }    
@@ -90,6 +115,8 @@ namespace unimelb {
     inline void incNumOfChanges(){ numOfChanges++;  }
     /// Reset to zero the number of changes.
     inline void resetNumOfChanges(){ numOfChanges=0;  }
+    /// Set the number of changes (e.g., restored from a previous run).
+    inline void setNumOfChanges(unsigned N){ numOfChanges=N;  }
     /// Method for support type inquiry through isa, cast, and
     /// dyn_cast.
     /// Set the basic block associated with the variable (if fixpointSSI)
@@ -128,7 +155,7 @@ namespace unimelb {
     virtual bool isEqual(AbstractValue *V) = 0;
     /// Widen this by using V, and optionally a jump-set J.
     /// lessOrEqual(V) must return true.
-    virtual void widening(AbstractValue *V, const std::vector<int64_t> &J) = 0;
+    virtual void widening(AbstractValue *V, const LandmarkSet &J) = 0;
     /// Pretty-printer of the abstract value.
     virtual void print(raw_ostream &Out) const{
       if (!isConstant()){
@@ -139,16 +166,31 @@ namespace unimelb {
     /// Return true if this is syntactically equal to V.
     virtual bool isIdentical(AbstractValue *V) = 0;
 
-    // Specific transfer functions
+    /// Write the contents of the abstract value (but not the variable
+    /// it belongs to) as space-separated tokens that read can parse.
+    virtual void write(raw_ostream &Out) const = 0;
+    /// Overwrite the contents of the abstract value with the tokens
+    /// written by write, removing them from Str. Return false if
+    /// they are malformed (then the abstract value is unchanged).
+    virtual bool read(StringRef &Str) = 0;
+    /// Return the width and the bounds, as unsigned integers, of an
+    /// abstract value which is neither bottom nor top. Return false
+    /// if the domain has no bounds or they do not fit in 64 bits.
+    virtual bool getBounds(unsigned &Width, uint64_t &Lo, uint64_t &Hi) const {
+      return false;
+    }
+
+    // Specific transfer functions. They store the result in this
+    // so the caller decides where the memory comes from.
 
     /// Execute an arithmetic operation in the abstract domain.
-    virtual AbstractValue * visitArithBinaryOp(AbstractValue *, AbstractValue *,
-					       unsigned, const char *) = 0;
+    virtual void visitArithBinaryOp(AbstractValue *, AbstractValue *,
+				    unsigned, const char *) = 0;
     /// Execute a bitwise operation in the abstract domain.
-    virtual AbstractValue * visitBitwiseBinaryOp(AbstractValue *, AbstractValue *, 
-						 const Type *,const Type *, unsigned, const char *) = 0;
+    virtual void visitBitwiseBinaryOp(AbstractValue *, AbstractValue *, 
+				      const Type *,const Type *, unsigned, const char *) = 0;
     /// Execute a casting operation in the abstract domain.
-    virtual AbstractValue * visitCast(Instruction &, AbstractValue *, TBool*, bool) = 0;
+    virtual void visitCast(Instruction &, AbstractValue *, TBool*, bool) = 0;
 
     // Methods to evaluate a guard
     virtual bool comparisonSle(AbstractValue *) = 0;
@@ -120,6 +120,17 @@ namespace unimelb {
       __isTop = I.__isTop;
     }
 
+    // Overwrite this with V (APInt reuses its storage if same width)
+    virtual void assign(AbstractValue *V){
+      AbstractValue::assign(V);
+      BaseRange *I = static_cast<BaseRange*>(V);
+      width=I->width;
+      isSigned=I->isSigned;
+      LB = I->LB;
+      UB = I->UB;
+      __isTop = I->__isTop;
+    }
+
     // Destructor
     virtual ~BaseRange(){}
 
@@ -248,6 +259,10 @@ namespace unimelb {
     virtual void makeTop();
     /// Print the abstract element.
     virtual void print(raw_ostream &) const;
+    /// Write/read the abstract element to/from text.
+    virtual void write(raw_ostream &) const;
+    virtual bool read(StringRef &);
+    virtual bool getBounds(unsigned &Width, uint64_t &Lo, uint64_t &Hi) const;
 
     // Common operations in derived classes.
 
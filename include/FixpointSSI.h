@@ -66,6 +66,12 @@
 #include "AbstractValue.h"
 #include "Support/Utils.h"
 #include "Support/TBool.h"
+#include "Support/FlagTable.h"
+#include "Support/PriorityWorkList.h"
+#include "Support/WTO.h"
+#include "Support/Parallel.h"
+#include "Support/Fingerprint.h"
+#include "Support/ResultStore.h"
 #include "llvm/Module.h"
 #include "llvm/Function.h"
 #include "llvm/BasicBlock.h"
@@ -79,12 +85,16 @@
 #include "llvm/Support/InstIterator.h"
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/TimeValue.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/PostOrderIterator.h"
 #include <tr1/memory>
 #include <set>
+#include <algorithm>
 #include <stack>
 
 using namespace std;
@@ -96,8 +106,9 @@ using namespace llvm;
 
 namespace unimelb {
 
-  /// Type that represents an abstract state.
-  /// The fixpoint keeps a single map from Values to AbstractValues. 
+  /// Type that represents an abstract state as a map from Values to
+  /// AbstractValues. The fixpoint keeps internally a single state
+  /// indexed by slots (see below) and only builds this map on demand.
   typedef DenseMap<Value*, AbstractValue*> AbstractStateTy;  
   typedef SmallPtrSet<Value*,8> SmallValueSet;
   /// Map from variable V to a set of sigma nodes S. V is a variable
@@ -228,49 +239,156 @@ namespace unimelb {
   // This only used for widening
   enum OrderingTy { LESS_THAN, LEX_LESS_THAN };
 
+  /// Order in which the fixpoint visits the instructions.
+  /// - CHAOTIC: worklist driven by def-use chains.
+  /// - WTO_RECURSIVE: recursive strategy over a weak topological
+  ///   ordering of the CFG. Inner components are stabilized before
+  ///   outer ones and widening is applied only at component heads.
+  enum IterationStrategyTy { CHAOTIC, WTO_RECURSIVE };
+
+  /// Summaries of the return values of the analyzed functions. They
+  /// are computed bottom-up over the SCCs of the call graph (see
+  /// RangePass.cpp) for any value of the arguments and are shared by
+  /// all the instances of the analysis.
+  ///
+  /// A function whose calls are all analyzed also collects the values
+  /// of its actual parameters at each call site. They are computed
+  /// top-down over the SCCs and used as the initial values of its
+  /// formal parameters instead of top.
+  class SummaryTable {
+  public:
+    /// Values of the actual parameters at a call site, one per formal
+    /// parameter. Values[k] is NULL if the k-th parameter is a
+    /// Boolean flag (then Flags[k] is used) or it is not tracked.
+    struct CallSiteArgs {
+      std::vector<AbstractValue*> Values;
+      std::vector<TBool> Flags;
+    };
+
+    struct Entry {
+      Entry(): Value(NULL), ArgsKnown(false){ Flag.makeBottom(); }
+      ~Entry(){
+	delete Value;
+	for (unsigned i=0, e=CallSites.size(); i < e; i++){
+	  for (unsigned k=0, ke=CallSites[i]->Values.size(); k < ke; k++)
+	    delete CallSites[i]->Values[k];
+	  delete CallSites[i];
+	}
+      }
+      /// Return value if it is an integer (NULL means bottom).
+      AbstractValue *Value;
+      /// Return value if it is a Boolean flag.
+      TBool Flag;
+      /// Whether all the calls to the function are analyzed so its
+      /// parameters can start from the values at its call sites.
+      bool ArgsKnown;
+      /// Parameters at each analyzed call site (only if ArgsKnown).
+      std::vector<CallSiteArgs*> CallSites;
+      DenseMap<CallInst*,unsigned> CallSiteIndex;
+      /// Callers analyzed in parallel may add call sites at the same time.
+      Mutex Lock;
+    };
+
+    /// Constructor of the class.
+    SummaryTable(){}
+    /// Destructor of the class.
+    ~SummaryTable(){
+      for (DenseMap<Function*,Entry*>::iterator 
+	     I = Entries.begin(), E = Entries.end(); I != E; ++I)
+	delete I->second;
+    }
+    /// Add an entry for F. All the entries must be added before the
+    /// analysis starts since other threads may be reading the table.
+    inline void add(Function *F){
+      if (!Entries.count(F))
+	Entries[F] = new Entry();
+    }
+    /// Return the entry of F or NULL if F has no summary.
+    inline Entry* lookup(Function *F) const {
+      DenseMap<Function*,Entry*>::const_iterator It = Entries.find(F);
+      if (It == Entries.end()) return NULL;
+      return It->second;
+    }
+
+  private:
+    DenseMap<Function*,Entry*> Entries;
+    // Not copyable
+    SummaryTable(const SummaryTable&);
+    void operator=(const SummaryTable&);
+  };
+
   class FixpointSSI {    
   private:
     // To compute the fixpoint. 
     void solveLocal(Function *);
     void computeFixpo();
+    // Recursive iteration strategy over the WTO.
+    void computeFixpoWTO(unsigned, unsigned);
+    void stabilizeComponent(unsigned);
+    void visitBlock(unsigned);
     // To perform narrowing.
     void computeNarrowing(Function *);
     void computeOneNarrowingIter(Function *);
+    void computeSparseNarrowing(Function *);
 
     /// Record a block as executable.
-    void markBlockExecutable(BasicBlock *);
+    void markBlockExecutable(unsigned);
     /// Record an CFG edge as feasible (i.e., executable).
-    void markEdgeExecutable(BasicBlock *,BasicBlock *);
+    void markEdgeExecutable(unsigned);
     /// Return true if the edge is feasible.
-    bool isEdgeFeasible(BasicBlock *, BasicBlock *);
+    bool isEdgeFeasible(unsigned);
     /// Check if abstract value changed during last execution.
-    void updateState(Instruction &, AbstractValue *);
+    void updateState(unsigned, AbstractValue *);
+    /// Return the scratch value of the slot holding a copy of its
+    /// current abstract value. The transfer functions write on it
+    /// and updateState swaps it with the current value only if
+    /// there is a change. Memory is allocated only the first time.
+    inline AbstractValue* getScratch(unsigned Slot){
+      AbstractValue *&S = Scratch[Slot];
+      if (!S) 
+	S = AbsState[Slot]->clone(Arena);
+      else
+	S->assign(AbsState[Slot]);
+      return S;
+    }
     /// Check if Boolean flag changed during last execution.
-    void updateCondFlag(Instruction &, TBool *);
+    void updateCondFlag(unsigned, TBool);
+    /// Record that the value of the instruction has changed.
+    inline void notifyChange(unsigned Slot){
+      if (Strategy == WTO_RECURSIVE)
+	NumOfBlockChanges[InstBlock[Slot]]++;
+      else{
+	DEBUG(dbgs() << "***Added into I-WL: " << *SlotValue[Slot] << "\n");
+	InstWorkList.insert(Slot);
+      }
+    }
 
-    /// Execute an instruction I.
-    void visitInst(Instruction &I);
+    /// Execute the instruction stored in a slot.
+    void visitInst(unsigned);
     /// Execute a PHI instruction I if the domain is a lattice.
-    void visitPHINode(PHINode &I);
+    void visitPHINode(unsigned, PHINode &I);
     /// Execute a PHI instruction I if the domain is not a lattice.
-    void visitPHINode(AbstractValue *&AbsVal, PHINode &I);
+    void visitPHINode(AbstractValue *&AbsVal, unsigned, PHINode &I);
     /// Execute a Store instruction I.
     void visitStoreInst(StoreInst &I);
     /// Execute a Select instruction I
-    void visitSelectInst(SelectInst &I);
+    void visitSelectInst(unsigned, SelectInst &I);
     /// Execute a Load instruction I.
-    void visitLoadInst(LoadInst &I);
+    void visitLoadInst(unsigned, LoadInst &I);
     /// Execute a Return instruction I.
     void visitReturnInst(ReturnInst &I);
     /// Execute a Call instruction I.
-    void visitCallInst(CallInst &I); 
+    void visitCallInst(unsigned, CallInst &I); 
     /// Execute a Terminator instruction I.
-    void visitTerminatorInst(TerminatorInst &I);
+    void visitTerminatorInst(unsigned, TerminatorInst &I);
     /// Execute a Comparison instruction I.
-    void visitComparisonInst(ICmpInst &I);
+    void visitComparisonInst(unsigned, ICmpInst &I);
+    /// Return true iff the meet of the operands of the comparison
+    /// Slot is empty. The meet is computed on the scratch value of Slot.
+    bool IsMeetEmpty(unsigned Slot, AbstractValue *, AbstractValue *);
     /// Execute a Sigma instruction
-    void visitSigmaNode(AbstractValue *LHSSigma, Value * RHSSigma);
-    void visitSigmaNode(AbstractValue *LHSSigma, Value * RHSSigma, 
+    void visitSigmaNode(AbstractValue *LHSSigma, unsigned);
+    void visitSigmaNode(AbstractValue *LHSSigma, unsigned, 
 			BasicBlock *, BranchInst * BI);
 
     void generateFilters(Value *, Value *, BranchInst *, BasicBlock *); 
@@ -280,38 +398,118 @@ namespace unimelb {
     // bool evalFilter(AbstractValue * &, Value *, const FiltersTy );
     /// Execute a Boolean logical instruction: and/or/xor whose
     /// operatons of i1.
-    void visitBooleanLogicalInst(Instruction &I);
-
+    void visitBooleanLogicalInst(unsigned, Instruction &I);
+
+    ///  Give a slot to every block, edge, instruction and argument
+    ///  of F.
+    void addSlots(Function *F);
+    ///  Record for each instruction of F the slots of its operands.
+    void addOperandSlots(Function *F);
+    ///  Normalize the comparisons of F.
+    void addCmpDescriptors(Function *F);
+    ///  Generate the filters of the sigma nodes of F.
+    void addSigmaFilters(Function *F);
+    ///  Build the dependency graph between the slots of F.
+    void addUserSlots(Function *F);
     ///  Mark the global variables of the module M.
     void addTrackedGlobalVariables(Module *M);
     void addTrackedGlobalVariablesPessimistically(Module *);
     ///  Mark the abstraction points of the function F.
     void addTrackedWideningPoints(Function *F);
+    void addWideningLandmarks();
+    void getLoopBody(unsigned Header, BitVector &Body);
+
+    ///  Warm start
+    std::string getSnapshotPath(Function *F);
+    uint64_t getCFGFingerprint(Function *F);
+    uint64_t getInstFingerprint(unsigned Slot);
+    bool loadSnapshot(Function *F);
+    void saveSnapshot(Function *F);
+    ///  Result store
+    void storeResults(Function *F);
+    // Budgets
+    void checkBudget();
+    void exhaustBudget(const char *Budget);
+    void sendToTop(unsigned Slot);
     ///  Record the integer constants that appear in the function F.
     void addTrackedIntegerConstants(Function * F);
     void addTrackedValuesUsedSigmaNode(Value *,Value *); 
       
     /// Return true if widening must be applied.
-    bool Widen(Instruction *,unsigned);
+    bool Widen(unsigned,unsigned);
 
     /// Make conservative assumptions when the code of a function
     /// is not available or we do not want to analyze the function.
-    void FunctionWithoutCode(CallInst *, Function *, Instruction *);
+    void FunctionWithoutCode(CallInst *, Function *, unsigned);
+    void clobberModGlobals(CallInst *, Function *);
+    void applySummary(unsigned, CallInst &, SummaryTable::Entry &);
+    /// Initial value of a formal parameter from its call sites.
+    AbstractValue* initArgFromCallSites(Argument *, SummaryTable::Entry &);
+
+    /// Free the abstract values and flags of all slots. The values
+    /// live in the arena so we only need to run their destructors
+    /// (APInt's wider than 64 bits own memory) before resetting
+    /// it. The values of the constants are shared (see
+    /// isSharedSlot) and survive.
+    inline void releaseState(){
+      for (unsigned i=0, e=AbsState.size(); i < e; i++){
+	if (AbsState[i] && !isSharedSlot(i))
+	  AbsState[i]->destroy();
+      }
+      for (unsigned i=0, e=Scratch.size(); i < e; i++){
+	if (Scratch[i])
+	  Scratch[i]->destroy();
+      }
+      AbsState.clear();
+      Scratch.clear();
+      Flags.clear();
+      Arena.Reset();
+    }
 
     /// Cleanup to make sure the analysis of a function does not
     /// interfere with other functions.
     inline void Cleanup(){
-      ValueState.clear();
-      TrackedCondFlags.clear();
+      releaseState();
+      SlotValue.clear();
+      SlotMap.clear();
+      NumOfInstSlots=0;
+      InstBlock.clear();
+      OperandBegin.clear();
+      OperandSlots.clear();
+      OperandEdges.clear();
+      CmpDescs.clear();
+      UserBegin.clear();
+      UserSlots.clear();
+      for (SigmaUsersTy::iterator I = TrackedValuesUsedSigmaNode.begin(),
+	     E = TrackedValuesUsedSigmaNode.end(); I != E; ++I)
+	delete I->second;
+      TrackedValuesUsedSigmaNode.clear();
+      SigmaFilters.clear();
+      Blocks.clear();
+      BlockMap.clear();
+      BlockBegin.clear();
+      EdgeBegin.clear();
+      EdgeDest.clear();
       InstWorkList.clear();
       BBWorkList.clear();
       BBExecutable.clear();
       KnownFeasibleEdges.clear();
       WideningPoints.clear();
+      NarrowingSeeds.clear();
+      delete WTO;
+      WTO = NULL;
+      NumOfBlockChanges.clear();
+      ActiveComponents.clear();
 #ifdef SKIP_TRAP_BLOCKS
       TrackedTrapBlocks.clear();
 #endif 
-      ConstSet.clear();
+      Landmarks.clear();
+      LandmarkIndex.clear();
+      WarmStarted = false;
+      WarmSeeds.clear();
+      NumOfWideningsAt.clear();
+      ExhaustedBudget = NULL;
+      ForceTop = false;
     }
     
   public:    
@@ -336,58 +534,218 @@ namespace unimelb {
     void printResultsGlobals(raw_ostream &);
     void printResultsFunction(Function *, raw_ostream &);
 
-    /// Create a bottom abstract value.
-    virtual AbstractValue* initAbsValBot(Value *)=0;
+    /// Short name of the analysis (e.g., to name its files).
+    virtual const char* getAnalysisName() const = 0;
+    /// Create a bottom abstract value. It is allocated in Arena if
+    /// not NULL (see allocateAbsVal) or in the heap otherwise.
+    virtual AbstractValue* initAbsValBot(Value *, BumpPtrAllocator *Arena=NULL)=0;
     /// Create a top abstract value.
-    virtual AbstractValue* initAbsValTop(Value *)=0;
+    virtual AbstractValue* initAbsValTop(Value *, BumpPtrAllocator *Arena=NULL)=0;
     /// Create an abstract value from an integer constant.
     virtual AbstractValue* initAbsIntConstant(ConstantInt *)=0;
     /// Create an abstract value from a value initialized to an
     /// integer constant.
-    virtual AbstractValue* initAbsValIntConstant(Value *,ConstantInt *)=0;
-
-    /// To provide the analysis results to other passes.
-    /// FIXME: not nice since we are returning internal information.
-    inline AbstractStateTy getValMap() const { 
-      return ValueState; 
-    } 
+    virtual AbstractValue* initAbsValIntConstant(Value *,ConstantInt *, 
+						 BumpPtrAllocator *Arena=NULL)=0;
+
+    /// Results of the last analyzed function. They are valid until
+    /// the next call to init (see WrappedRangeInfo to keep the
+    /// results of several functions).
+    ///
+    /// Return the abstract value of V or NULL if V is not tracked.
+    inline AbstractValue* getAbsValue(Value *V) const {
+      unsigned Slot = getSlot(V);
+      return (Slot == NoSlot ? NULL : AbsState[Slot]);
+    }
     inline bool IsReachable(BasicBlock *B) const {
-      return (BBExecutable.count(B) > 0);
+      DenseMap<BasicBlock*,unsigned>::const_iterator It = BlockMap.find(B);
+      return (It != BlockMap.end() && BBExecutable.test(It->second));
+    }
+    /// Return true if the edge from From to its successor To is feasible.
+    bool IsEdgeFeasible(BasicBlock *From, BasicBlock *To) const;
+    /// Build a map with the abstract value of every tracked value.
+    AbstractStateTy getValMap() const;
+    /// Choose the iteration strategy. It must be called before init.
+    inline void setIterationStrategy(IterationStrategyTy S){
+      Strategy = S;
     }
+    /// If enabled, narrowing re-evaluates only the values that may
+    /// decrease instead of making full passes over the function.
+    inline void setSparseNarrowing(bool V){
+      SparseNarrowing = V;
+    }
+    /// If Dir is not empty, the final state of each analyzed function
+    /// is saved in Dir. The next analysis of the same function starts
+    /// from that state if the CFG of the function did not change and
+    /// revisits only the instructions that changed.
+    inline void setWarmStartDir(const std::string &Dir){
+      WarmStartDir = Dir;
+    }
+    /// Budgets of the analysis of each function (0 means no limit):
+    /// number of instruction visits, wall time in milliseconds and
+    /// number of widenings at each widening point. A widening point
+    /// that runs out of widenings goes directly to top. If one of the
+    /// other two runs out then the values still in the worklist and
+    /// any value that changes afterwards go to top, so the fixpoint
+    /// is reached quickly and is still sound, and narrowing is
+    /// skipped.
+    inline void setBudgets(unsigned Visits, unsigned TimeMs, unsigned Widenings){
+      VisitBudget = Visits;
+      TimeBudget = TimeMs;
+      WideningBudget = Widenings;
+    }
+    /// If S is not NULL then calls to functions with an entry in S
+    /// use their summaries rather than top.
+    inline void setSummaries(SummaryTable *S){
+      Summaries = S;
+    }
+    /// If S is not NULL then the final results of each analyzed
+    /// function are added to S.
+    inline void setResultStore(ResultStoreWriter *S){
+      Store = S;
+    }
+    inline ResultStoreWriter* getResultStore() const { return Store; }
+    inline SummaryTable* getSummaries() const { return Summaries; }
+    inline Module* getModule() const { return M; }
+    inline AliasAnalysis* getAliasAnalysis() const { return AA; }
+    /// Join the return values of F (which must be the last analyzed
+    /// function) into its summary. If Widen then a summary that
+    /// changes goes to top. Return true if the summary changed.
+    bool updateReturnSummary(Function *F, bool Widen);
+    /// Join the actual parameters of the executable calls of F (which
+    /// must be the last analyzed function) into the call sites of the
+    /// callees whose parameters are known. If Widen then a call site
+    /// that changes goes to top. Return true if some call site changed.
+    bool updateCallSiteArgs(Function *F, bool Widen);
+    /// Return the budget that the analysis of the last function ran
+    /// out of, or NULL if none.
+    inline const char* getExhaustedBudget() const { return ExhaustedBudget; }
+
+    /// Special slot for values which are not tracked.
+    static const unsigned NoSlot = ~0U;
+    /// Several functions can be analyzed in parallel by different
+    /// instances of the class. This lock serializes the few places
+    /// where the analysis touches state shared by all the functions
+    /// (i.e., the LLVMContext and the use lists of constants) or
+    /// the alias analysis.
+    static Mutex IRLock;
 
   private:
+    // Not copyable: the instance owns its arena and the values of
+    // the interned constants.
+    FixpointSSI(const FixpointSSI&);
+    void operator=(const FixpointSSI&);
+
     Module * M;     //!< The module where the analysis lives.
-    AbstractStateTy ValueState; //!< Map Values to abstract values.
-    DenseMap<Value*,TBool*> TrackedCondFlags; //!< Map Values to Boolean flags.
-    std::set<Value*> InstWorkList; //!< Worklist of instructions to process.
-    std::set<BasicBlock*>  BBWorkList; //!< Worlist of blocks to process.
-    SmallPtrSet<BasicBlock*, 16>  BBExecutable; //!< Set of executable blocks.  
-    typedef std::pair<BasicBlock*,BasicBlock*> Edge; //!< CFG edge.
-    std::set<Edge>  KnownFeasibleEdges;  //!< Set of executable edges.
+
+    ///////////////////////////////////////////////////////////////////
+    // Representation of the abstract state.
+    //
+    // Every block, CFG edge, instruction, argument, integer constant
+    // and tracked global of the current function is given a number
+    // (slot) once in init. Blocks are numbered following a reverse
+    // post-order of the CFG (unreachable blocks go last) and the
+    // instructions of each block have consecutive slots starting at
+    // 0. Arguments, constants and globals go after the instructions.
+    // The abstract state lives in vectors indexed by slot.
+    ///////////////////////////////////////////////////////////////////
+
+    std::vector<Value*> SlotValue;          //!< Value of each slot.
+    DenseMap<Value*,unsigned> SlotMap;      //!< Slot of each value.
+    std::vector<AbstractValue*> AbsState;   //!< Abstract value of each slot.
+    std::vector<AbstractValue*> Scratch;    //!< Reusable value for the transfer function of each slot.
+    FlagTable Flags;                        //!< Boolean flag of each slot.
+    /// Memory of the abstract values (but constants) of the slots. It
+    /// is released at once by Cleanup.
+    BumpPtrAllocator Arena;
+    unsigned NumOfInstSlots;                //!< Number of instructions.
+    std::vector<unsigned> InstBlock;        //!< Block of each instruction.
+    /// The slots of the operands of instruction I are
+    /// OperandSlots[OperandBegin[I]...OperandBegin[I+1]-1] (NoSlot if
+    /// the operand is not tracked).
+    std::vector<unsigned> OperandBegin;    
+    std::vector<unsigned> OperandSlots;
+    /// For a PHI node, the edge of each incoming value.
+    std::vector<unsigned> OperandEdges;
+    /// Comparison of an ICmpInst once normalized: its predicate is
+    /// one of EQ, NE, SLE, SLT, ULE or ULT and Op1 and Op2 are the
+    /// slots of its operands (maybe swapped) or NoSlot.
+    struct CmpDescriptor {
+      CmpDescriptor(): Pred(CmpInst::BAD_ICMP_PREDICATE), Op1(NoSlot), Op2(NoSlot){}
+      CmpInst::Predicate Pred;
+      unsigned Op1, Op2;
+    };
+    /// Comparison descriptor of each instruction slot (only
+    /// meaningful for ICmpInst's).
+    std::vector<CmpDescriptor> CmpDescs;
+    /// The slots to revisit when the value of slot S changes are
+    /// UserSlots[UserBegin[S]...UserBegin[S+1]-1]: the users of S plus
+    /// the sigma nodes whose filter mentions S.
+    std::vector<unsigned> UserBegin;
+    std::vector<unsigned> UserSlots;
+    std::vector<BasicBlock*> Blocks;        //!< Block of each block slot.
+    DenseMap<BasicBlock*,unsigned> BlockMap;//!< Slot of each block.
+    /// The instructions of block B are in [BlockBegin[B],BlockBegin[B+1]).
+    std::vector<unsigned> BlockBegin;
+    /// The edge from B to its i-th successor is EdgeBegin[B]+i, unless
+    /// the same successor appears several times in which case all of
+    /// them share the edge of the first one.
+    std::vector<unsigned> EdgeBegin;
+    std::vector<unsigned> EdgeDest;         //!< Destination of each edge.
+
+    /// Worklist of instructions to process ordered by reverse post-order.
+    PriorityWorkList InstWorkList; 
+    /// Worklist of blocks to process ordered by reverse post-order.
+    PriorityWorkList BBWorkList;
+    BitVector BBExecutable;       //!< Set of executable blocks.  
+    BitVector KnownFeasibleEdges; //!< Set of executable edges.
 
     /// If a sigma node S depends on a comparison instruction that
     /// involves two variables X and Y, S will be user only of one of
     /// them. We use this map to remember that S is user of both X and
-    /// Y.
+    /// Y. It is only used to build UserSlots.
     SigmaUsersTy TrackedValuesUsedSigmaNode;    
     SigmaFiltersTy SigmaFilters; 
    
-    /// Set of widening points.
-    SmallPtrSet<Instruction*,16> WideningPoints;
+    /// Set of widening points (instruction slots).
+    BitVector WideningPoints;
     /// If zero then widening will not be applied. Otherwise, it
     /// refers to the number of times an abstract value must change
     /// until we widen it. Once, we widen a value its counter starts
     /// from 0 again.
     unsigned WideningLimit; 
-    /// Set of integer constants that appear in the program. Used by
-    /// jump-set widening.
-    std::vector<int64_t> ConstSet; 
+    /// Landmarks of the jump-set widening of each loop: the integer
+    /// constants used inside the loop and by the comparisons that
+    /// guard its exits. The widening point S uses
+    /// Landmarks[LandmarkIndex[S]].
+    std::vector<LandmarkSet> Landmarks;
+    std::vector<unsigned> LandmarkIndex;
+    /// Whether the landmarks are for classical (LESS_THAN) or
+    /// wrapped (LEX_LESS_THAN) intervals.
     OrderingTy ConstSetOrder;
     /// If NarrowingLimit zero then narrowing will not be applied.
     unsigned NarrowingLimit;
     /// Internal flag for the analysis to know that it is performing
     /// narrowing.
     bool NarrowingPass;
+    /// Narrowing strategy.
+    bool SparseNarrowing;
+    /// Instructions whose value may be improved by narrowing: those
+    /// widened and those whose last evaluation was strictly more
+    /// precise than their current value (only if SparseNarrowing).
+    BitVector NarrowingSeeds;
+
+    /// Iteration strategy.
+    IterationStrategyTy Strategy;
+    /// Weak topological ordering of the current function (only if
+    /// Strategy is WTO_RECURSIVE).
+    WeakTopologicalOrder *WTO;
+    /// Number of times the value of some instruction of a block has
+    /// changed (only if Strategy is WTO_RECURSIVE).
+    std::vector<unsigned> NumOfBlockChanges;
+    /// Positions in the WTO of the heads of the components being
+    /// stabilized, outermost first (only if Strategy is WTO_RECURSIVE).
+    std::vector<unsigned> ActiveComponents;
 
     /// AA - Alias Information 
     AliasAnalysis * AA;
@@ -395,27 +753,132 @@ namespace unimelb {
     /// Set of global variables that the analysis will keep track of.
     SmallPtrSet<GlobalVariable*, 64> TrackedGlobals;
 
+    /// Abstract value of each integer constant seen so far. They are
+    /// never modified so all the slots of the same constant, in any
+    /// function, point to the same value. LLVM uniques the constants
+    /// so the same width and value means the same ConstantInt.
+    DenseMap<ConstantInt*,AbstractValue*> InternedConstants;
+    AbstractValue* internConstant(ConstantInt *C);
+    /// Top value of each width, shared by the slots of the integer
+    /// operands that are neither instructions, arguments nor
+    /// ConstantInt's (e.g., undef or constant expressions). They are
+    /// never modified either. The values of instructions and
+    /// arguments, including top and bottom ones, are not shared
+    /// since they change in place and know their Value and block.
+    DenseMap<unsigned,AbstractValue*> InternedTops;
+    AbstractValue* internTop(Value *V, unsigned Width);
+    /// Return true if the value of Slot is shared (see
+    /// InternedConstants and InternedTops).
+    inline bool isSharedSlot(unsigned Slot) const {
+      Value *V = SlotValue[Slot];
+      return (isa<Constant>(V) && !isa<GlobalValue>(V));
+    }
+
+    /// Directory of the warm-start snapshots (empty if disabled).
+    std::string WarmStartDir;
+    /// Whether the state of the current function was loaded from a
+    /// snapshot and, if yes, the instructions that changed since.
+    bool WarmStarted;
+    std::vector<unsigned> WarmSeeds;
+
+    /// Budgets (see setBudgets) and what the current function has
+    /// consumed of them.
+    unsigned VisitBudget;
+    unsigned TimeBudget;
+    unsigned WideningBudget;
+    unsigned NumOfVisits;
+    sys::TimeValue StartTime;
+    /// Number of widenings of each instruction slot (only if
+    /// WideningBudget is not zero).
+    std::vector<unsigned> NumOfWideningsAt;
+    /// Name of the budget the current function ran out of (NULL if none).
+    const char *ExhaustedBudget;
+    /// Whether every change must go directly to top because the
+    /// visits or the time of the current function ran out.
+    bool ForceTop;
+
+    /// Summaries of the callees (NULL if none).
+    SummaryTable *Summaries;
+    /// Where the final results go (NULL if none).
+    ResultStoreWriter *Store;
+
     /// [HOOK] To consider all integers signed or not.
     bool IsAllSigned;
 
 #ifdef SKIP_TRAP_BLOCKS
-    DenseMap<BasicBlock*,unsigned int> TrackedTrapBlocks;
+    BitVector TrackedTrapBlocks;
 #endif 
 
+    /// Give a slot to V if it does not have one yet and return it.
+    inline unsigned addSlot(Value *V){
+      std::pair<DenseMap<Value*,unsigned>::iterator,bool> It = 
+	SlotMap.insert(std::make_pair(V, (unsigned) SlotValue.size()));
+      if (It.second){
+	SlotValue.push_back(V);
+	AbsState.push_back(NULL);
+	Scratch.push_back(NULL);
+	Flags.push_back();
+      }
+      return It.first->second;
+    }
+    /// Return the slot of V or NoSlot.
+    inline unsigned getSlot(Value *V) const {
+      DenseMap<Value*,unsigned>::const_iterator It = SlotMap.find(V);
+      if (It == SlotMap.end()) return NoSlot;
+      return It->second;
+    }
+    /// Return the slot of the block BB or NoSlot.
+    inline unsigned getBlockSlot(BasicBlock *BB) const {
+      DenseMap<BasicBlock*,unsigned>::const_iterator It = BlockMap.find(BB);
+      if (It == BlockMap.end()) return NoSlot;
+      return It->second;
+    }
+    inline unsigned getNumOperands(unsigned Slot) const {
+      return OperandBegin[Slot+1] - OperandBegin[Slot];
+    }
+    /// Return the slot of the k-th operand of the instruction Slot.
+    inline unsigned getOperandSlot(unsigned Slot, unsigned k) const {
+      return OperandSlots[OperandBegin[Slot]+k];
+    }
+    /// Return the abstract value of the k-th operand of the
+    /// instruction Slot or NULL if not tracked.
+    inline AbstractValue* getOperandAbsVal(unsigned Slot, unsigned k) const {
+      unsigned S = getOperandSlot(Slot,k);
+      if (S == NoSlot) return NULL;
+      return AbsState[S];
+    }
+    /// Copy in F the flag of the k-th operand of the instruction
+    /// Slot. Return false if not tracked.
+    inline bool getOperandFlag(unsigned Slot, unsigned k, TBool &F) const {
+      unsigned S = getOperandSlot(Slot,k);
+      if (S == NoSlot || !Flags.has(S)) return false;
+      F = Flags.get(S);
+      return true;
+    }
+    /// Return true if the instruction Slot is in an executable block.
+    inline bool isExecutableInst(unsigned Slot) const {
+      return BBExecutable.test(InstBlock[Slot]);
+    }
 
     /// Return true if the instruction has a left-hand side.
     inline bool HasLeftHandSide(Instruction &I);
-    /// Lookup in ValueState covering the special case if the value is
-    /// undefined.
+    /// Lookup the abstract value of V covering the special case if
+    /// the value is undefined.
     AbstractValue* Lookup(Value *V,  bool ExceptionIfNotFound);
     /// Succeed if the value is a Boolean flag which is being tracked.
     inline bool isTrackedCondFlag(Value *V);
+    /// Copy in F the flag of V. Return false if not tracked.
+    inline bool LookupCondFlag(Value *V, TBool &F);
     /// Succeed if the value is "true".
     inline bool isTrueConstant(Value *V);
     /// Succeed if the value is "false".
     inline bool isFalseConstant(Value *V);
-    /// Convert a Value into a TBool. Otherwise, return NULL.
-    TBool* getTBoolfromValue(Value *V);
+    /// Convert V (a tracked flag or a Boolean constant) into a
+    /// TBool. Otherwise, return false and leave F unchanged.
+    inline bool getTBoolfromValue(Value *V, TBool &F);
+    /// Convert the k-th operand of the instruction Slot into a
+    /// TBool. Otherwise, return false.
+    inline bool getTBoolfromOperand(unsigned Slot, unsigned k, TBool &F);
     /// Return true if Value is a Boolean flag.
     inline bool  isCondFlag(Value *V);
     /// Return true if the type of the instruction is
@@ -447,55 +910,65 @@ namespace unimelb {
     return false;
   }
   
-  AbstractValue* FixpointSSI::Lookup(Value *V,  bool ExceptionIfNotFound){
+  inline AbstractValue* FixpointSSI::Lookup(Value *V,  bool ExceptionIfNotFound){
     AbstractValue* AbsVal=NULL;
-    if (V->getValueID() != Value::UndefValueVal)
-      AbsVal = ValueState.lookup(V);
-    
-      assert(!ExceptionIfNotFound || AbsVal);      
-      return AbsVal;
-      
+    if (V->getValueID() != Value::UndefValueVal){
+      unsigned Slot = getSlot(V);
+      if (Slot != NoSlot)
+	AbsVal = AbsState[Slot];
+    }
+    assert(!ExceptionIfNotFound || AbsVal);      
+    return AbsVal;
   }
   
   inline bool FixpointSSI::isTrackedCondFlag(Value *V){
-    DenseMap<Value*,TBool*>::iterator I = TrackedCondFlags.find(V);
-    return (I != TrackedCondFlags.end());
+    unsigned Slot = getSlot(V);
+    return (Slot != NoSlot && Flags.has(Slot));
+  }
+
+  inline bool FixpointSSI::LookupCondFlag(Value *V, TBool &F){
+    unsigned Slot = getSlot(V);
+    if (Slot == NoSlot || !Flags.has(Slot)) return false;
+    F = Flags.get(Slot);
+    return true;
   }
 
+  // We do not compare against ConstantInt::getTrue/getFalse since
+  // they may create the constant in the LLVMContext.
   inline bool FixpointSSI::isTrueConstant(Value *V){      
     if (V->getType()->isIntegerTy(1)){
-	if (ConstantInt *C = dyn_cast<ConstantInt>(V)){	  
-	  Constant * True = dyn_cast<Constant>(V);
-	  return (True == C->getTrue(V->getType()->getContext()));
-	}
+	if (ConstantInt *C = dyn_cast<ConstantInt>(V))
+	  return C->isOne();
     }
     return false;
     }
   
   inline bool FixpointSSI::isFalseConstant(Value *V){      
     if (V->getType()->isIntegerTy(1)){
-      if (ConstantInt *C = dyn_cast<ConstantInt>(V)){	  
-	Constant * True = dyn_cast<Constant>(V);
-	return (True == C->getFalse(V->getType()->getContext()));
-      }
+      if (ConstantInt *C = dyn_cast<ConstantInt>(V))
+	return C->isZero();
       }
     return false;
   }
   
-  TBool* FixpointSSI::getTBoolfromValue(Value *V){
-    if (isTrackedCondFlag(V))
-      return TrackedCondFlags[V];      
+  inline bool FixpointSSI::getTBoolfromValue(Value *V, TBool &F){
+    if (LookupCondFlag(V, F))
+      return true;
     if (isTrueConstant(V)){
-      TBool * c = new TBool();
-      c->makeTrue();
-      return c;
-    }      
+      F.makeTrue();
+      return true;
+    }
     if (isFalseConstant(V)){
-      TBool * c = new TBool();
-      c->makeFalse();
-      return c;
-    } 
-    return NULL;      
+      F.makeFalse();
+      return true;
+    }
+    return false;      
+  }
+
+  inline bool FixpointSSI::getTBoolfromOperand(unsigned Slot, unsigned k, TBool &F){
+    if (getOperandFlag(Slot,k,F))
+      return true;
+    return getTBoolfromValue(cast<Instruction>(SlotValue[Slot])->getOperand(k), F);
   }
 
   inline bool  FixpointSSI::isCondFlag(Value *V){
@@ -509,7 +982,7 @@ namespace unimelb {
   }
     
   
-  bool FixpointSSI::IsBooleanLogicalOperator(Instruction *I){
+  inline bool FixpointSSI::IsBooleanLogicalOperator(Instruction *I){
     return (  I->getType()->isIntegerTy(1) && 
 	      (I->getOpcode() == Instruction::And ||
 	       I->getOpcode() == Instruction::Or ||
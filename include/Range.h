@@ -108,6 +108,9 @@ namespace unimelb {
     Range* clone(){
       return new Range(*this);
     }
+    Range* clone(BumpPtrAllocator &Arena){
+      return new (Arena.Allocate<Range>()) Range(*this);
+    }
 
     /// To support type inquiry through isa, cast, and dyn_cast.
     static inline bool classof(const Range *) { 
@@ -185,7 +188,7 @@ namespace unimelb {
 
     virtual void meet(AbstractValue *V1,AbstractValue *V2);
     virtual bool isEqual(AbstractValue *V);
-    virtual void widening(AbstractValue *, const std::vector<int64_t> &); 
+    virtual void widening(AbstractValue *, const LandmarkSet &); 
 		
     /// Return true is this is syntactically identical to V.
     virtual bool isIdentical(AbstractValue *V);
@@ -208,15 +211,15 @@ namespace unimelb {
 
     // addition, substraction, multiplication, signed/unsigned
     // division, and signed/unsigned rem.
-    virtual AbstractValue* visitArithBinaryOp(AbstractValue *, AbstractValue *,
-					      unsigned, const char *);
+    virtual void visitArithBinaryOp(AbstractValue *, AbstractValue *,
+				    unsigned, const char *);
     void DoArithBinaryOp(Range *,Range *,Range *,unsigned,const char *,bool &);
     void DoMultiplication(bool, Range *,Range *,Range *,bool &);
     void DoDivision(bool, Range *, Range *, Range *,bool &);
     void DoRem(bool, Range *, Range *, Range *,bool &);
 			 
     // and, or, xor, lsh, lshr, ashr
-    virtual AbstractValue* 
+    virtual void 
       visitBitwiseBinaryOp(AbstractValue *,AbstractValue *, 
 			   const Type *,const Type *,unsigned, const char *);    
     void DoBitwiseBinaryOp(Range *,Range *,Range *,const Type *,const Type *,unsigned,bool &);
@@ -229,7 +232,7 @@ namespace unimelb {
     // cast  instructions: truncate and signed/unsigned extension
 
     bool IsTruncateOverflow(Range *, unsigned);
-    virtual AbstractValue* visitCast(Instruction &,AbstractValue *,TBool*,bool);
+    virtual void visitCast(Instruction &,AbstractValue *,TBool*,bool);
     void DoCast(Range *,Range *,const Type *,const Type *,const unsigned,bool &);
 
     bool isCrossingSouthPole(Range *);
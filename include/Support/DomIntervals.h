@@ -0,0 +1,93 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __DOM_INTERVALS_H__
+#define __DOM_INTERVALS_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file DomIntervals.h
+///       Constant-time dominance queries.
+///
+/// Each block reachable from the entry is numbered with the times at
+/// which a depth-first traversal of the dominator tree enters (pre)
+/// and leaves (post) it. Then A dominates B iff the interval of B is
+/// contained in the interval of A:
+///
+/// \verbatim
+///   pre(A) <= pre(B) && post(B) <= post(A)
+/// \endverbatim
+///
+/// The numbers of several functions can be kept together: their
+/// intervals are disjoint so blocks of different functions never
+/// dominate each other. A block without number (unreachable) is only
+/// dominated by itself.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/BasicBlock.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <vector>
+#include <utility>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  class DominatorIntervals {
+  public:
+    /// Constructor of the class.
+    DominatorIntervals(): Clock(0){}
+    /// Constructor of the class. Number the blocks of DT.
+    DominatorIntervals(DominatorTree *DT): Clock(0){ addTree(DT); }
+    /// Destructor of the class.
+    ~DominatorIntervals(){}
+
+    /// Number the blocks of the dominator tree DT. If the blocks were
+    /// already numbered their old numbers are replaced.
+    void addTree(DominatorTree *DT){
+      DomTreeNode *Root = DT->getRootNode();
+      if (!Root) return;
+      // Explicit stack since dominator trees can be very deep.
+      std::vector<std::pair<DomTreeNode*, DomTreeNode::iterator> > Stack;
+      Intervals[Root->getBlock()].first = Clock++;
+      Stack.push_back(std::make_pair(Root, Root->begin()));
+      while (!Stack.empty()){
+	DomTreeNode *N = Stack.back().first;
+	if (Stack.back().second == N->end()){
+	  Intervals[N->getBlock()].second = Clock++;
+	  Stack.pop_back();
+	  continue;
+	}
+	DomTreeNode *Child = *Stack.back().second;
+	++Stack.back().second;
+	Intervals[Child->getBlock()].first = Clock++;
+	Stack.push_back(std::make_pair(Child, Child->begin()));
+      }
+    }
+
+    /// Return true if A dominates B.
+    inline bool dominates(BasicBlock *A, BasicBlock *B) const {
+      if (A == B) return true;
+      DenseMap<BasicBlock*, IntervalTy>::const_iterator IA = Intervals.find(A);
+      if (IA == Intervals.end()) return false;
+      DenseMap<BasicBlock*, IntervalTy>::const_iterator IB = Intervals.find(B);
+      if (IB == Intervals.end()) return false;
+      return (IA->second.first  <= IB->second.first &&
+	      IB->second.second <= IA->second.second);
+    }
+
+    /// Forget all the numbers.
+    void clear(){
+      Intervals.clear();
+      Clock = 0;
+    }
+
+  private:
+    typedef std::pair<unsigned, unsigned> IntervalTy; //!< (pre,post)
+    DenseMap<BasicBlock*, IntervalTy> Intervals;
+    unsigned Clock;
+  };
+
+} // end namespace
+
+#endif /*__DOM_INTERVALS_H__*/
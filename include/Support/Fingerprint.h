@@ -0,0 +1,51 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __FINGERPRINT_H__
+#define __FINGERPRINT_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file Fingerprint.h
+///       64-bit FNV-1a hash to recognize IR that did not change
+///       between two runs of the analysis.
+///
+/// The hash does not depend on addresses so it is stable across
+/// runs. It is not meant to resist collisions on purpose. A second,
+/// independent 64-bit hash of the same bytes (getCheck) lets a user
+/// that keys on get() detect a collision.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+
+namespace unimelb {
+
+  class Fingerprint {
+  public:
+    Fingerprint(): H(14695981039346656037ULL), G(0){}
+
+    inline void addByte(unsigned char C){
+      H ^= C;
+      H *= 1099511628211ULL;
+      G = ((G << 5) | (G >> 59)) ^ C;
+      G *= 0x9E3779B97F4A7C15ULL;
+    }
+    inline void add(uint64_t V){
+      for (unsigned i=0; i < 8; i++, V >>= 8)
+	addByte((unsigned char) (V & 0xFF));
+    }
+    inline void add(llvm::StringRef S){
+      add((uint64_t) S.size());
+      for (unsigned i=0, e=S.size(); i < e; i++)
+	addByte((unsigned char) S[i]);
+    }
+    inline uint64_t get() const { return H; }
+    inline uint64_t getCheck() const { return G; }
+
+  private:
+    uint64_t H;
+    uint64_t G;
+  };
+
+} // end namespace
+
+#endif /*__FINGERPRINT_H__*/
@@ -0,0 +1,81 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __FLAG_TABLE_H__
+#define __FLAG_TABLE_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file FlagTable.h
+///       Boolean flags (three-valued plus bottom) indexed by slot.
+///
+/// Each flag takes two bits (see TBool::getBits) so a word holds the
+/// flags of 32 slots. A separate bit per slot says whether the slot
+/// has a flag at all. Flags are read and written by value.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Support/TBool.h"
+#include "llvm/Support/DataTypes.h"
+#include <vector>
+
+namespace unimelb {
+
+  class FlagTable {
+  public:
+    /// Constructor of the class.
+    FlagTable(): Size(0){}
+    /// Destructor of the class.
+    ~FlagTable(){}
+
+    /// Number of slots.
+    inline unsigned size() const { return Size; }
+
+    /// Add a slot without flag.
+    inline void push_back(){
+      if ((Size % FlagsPerWord) == 0){
+	Bits.push_back(0);
+	Tracked.push_back(0);
+      }
+      Size++;
+    }
+
+    /// Remove all the slots.
+    inline void clear(){
+      Bits.clear();
+      Tracked.clear();
+      Size = 0;
+    }
+
+    /// Return true if the slot S has a flag.
+    inline bool has(unsigned S) const {
+      return (Tracked[S / FlagsPerWord] >> (S % FlagsPerWord)) & 1;
+    }
+
+    /// Give a flag to the slot S with the value B.
+    inline void add(unsigned S, TBool B = TBool()){
+      Tracked[S / FlagsPerWord] |= ((uint32_t) 1) << (S % FlagsPerWord);
+      set(S, B);
+    }
+
+    /// Return the flag of the slot S (which must have one).
+    inline TBool get(unsigned S) const {
+      return TBool::fromBits(Bits[S / FlagsPerWord] >> (2 * (S % FlagsPerWord)));
+    }
+
+    /// Overwrite the flag of the slot S (which must have one).
+    inline void set(unsigned S, TBool B){
+      unsigned Shift = 2 * (S % FlagsPerWord);
+      uint64_t &W = Bits[S / FlagsPerWord];
+      W = (W & ~(((uint64_t) 3) << Shift)) | (((uint64_t) B.getBits()) << Shift);
+    }
+
+  private:
+    static const unsigned FlagsPerWord = 32;
+    /// Two bits per slot.
+    std::vector<uint64_t> Bits;
+    /// One bit per slot: whether it has a flag.
+    std::vector<uint32_t> Tracked;
+    unsigned Size;
+  };
+
+} // end namespace
+
+#endif /*__FLAG_TABLE_H__*/
@@ -0,0 +1,88 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __LANDMARK_SET_H__
+#define __LANDMARK_SET_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file LandmarkSet.h
+///       Landmarks (jump points) of the jump-set widening.
+///
+/// The landmarks are built once per widening point in the form that
+/// the widening needs so that the widening itself only has to do a
+/// binary search:
+///
+/// - in signed order as int64_t's (classical intervals), or
+///
+/// - for each of the widths 8, 16, 32 and 64, the landmarks that fit
+///   in that width as unsigned words in increasing order, which is
+///   the lexicographical order used by wrapped intervals.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/Support/DataTypes.h"
+#include <vector>
+#include <algorithm>
+#include <set>
+
+namespace unimelb {
+
+  class LandmarkSet {
+  public:
+    /// Constructor of the class.
+    LandmarkSet(){}
+    /// Destructor of the class.
+    ~LandmarkSet(){}
+
+    /// Build the signed landmarks from the constants C.
+    void initSigned(const std::set<int64_t> &C){
+      Signed.assign(C.begin(), C.end());
+    }
+
+    /// Build the landmarks of each width from the constants C. A
+    /// constant fits in w bits if it is representable either as a
+    /// signed or as an unsigned integer of w bits.
+    void initWords(const std::set<int64_t> &C){
+      for (unsigned k=0; k < NumOfWidths; k++){
+	unsigned W = 8U << k;
+	std::vector<uint64_t> &Ws = Words[k];
+	Ws.clear();
+	for (std::set<int64_t>::const_iterator
+	       I = C.begin(), E = C.end(); I != E; ++I){
+	  if (W < 64){
+	    int64_t Min = -(((int64_t) 1) << (W-1));
+	    int64_t Max = (((int64_t) 1) << W) - 1;
+	    if (*I < Min || *I > Max) continue;
+	    Ws.push_back(((uint64_t) *I) & ((((uint64_t) 1) << W) - 1));
+	  }
+	  else
+	    Ws.push_back((uint64_t) *I);
+	}
+	std::sort(Ws.begin(), Ws.end());
+	Ws.erase(std::unique(Ws.begin(), Ws.end()), Ws.end());
+      }
+    }
+
+    /// Landmarks in signed order.
+    inline const std::vector<int64_t>& getSigned() const { return Signed; }
+
+    /// Landmarks of width Width in lexicographical order. Empty if
+    /// Width is not 8, 16, 32 or 64.
+    inline const std::vector<uint64_t>& getWords(unsigned Width) const {
+      switch (Width){
+      case 8:  return Words[0];
+      case 16: return Words[1];
+      case 32: return Words[2];
+      case 64: return Words[3];
+      default: return Words[NumOfWidths];
+      }
+    }
+
+  private:
+    static const unsigned NumOfWidths = 4;
+    std::vector<int64_t> Signed;
+    /// One table per width plus an empty one for the other widths.
+    std::vector<uint64_t> Words[NumOfWidths+1];
+  };
+
+} // end namespace
+
+#endif /*__LANDMARK_SET_H__*/
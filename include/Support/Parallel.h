@@ -0,0 +1,146 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file Parallel.h
+///       Minimal support to run independent tasks in parallel.
+///
+/// WorkStealingPool runs a fixed set of tasks on a number of threads.
+/// The tasks are dealt round-robin to the workers in the order given
+/// by the caller (so the first tasks should be the most expensive
+/// ones). A worker takes tasks from the front of its own queue and,
+/// once it is empty, steals from the back of the queues of the
+/// others. Tasks cannot create new tasks.
+///
+/// We use pthreads directly since the locks of LLVM (sys::Mutex) do
+/// nothing if LLVM was built without thread support.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <pthread.h>
+#include <vector>
+#include <deque>
+
+namespace unimelb {
+
+  /// Non-recursive mutex.
+  class Mutex {
+  public:
+    Mutex(){ pthread_mutex_init(&M, NULL); }
+    ~Mutex(){ pthread_mutex_destroy(&M); }
+    inline void lock()  { pthread_mutex_lock(&M); }
+    inline void unlock(){ pthread_mutex_unlock(&M); }
+  private:
+    pthread_mutex_t M;
+    // Not copyable
+    Mutex(const Mutex&);
+    void operator=(const Mutex&);
+  };
+
+  /// Hold the mutex while the object is alive.
+  class ScopedLock {
+  public:
+    ScopedLock(Mutex &_M): M(_M){ M.lock(); }
+    ~ScopedLock(){ M.unlock(); }
+  private:
+    Mutex &M;
+  };
+
+  class WorkStealingPool {
+  public:
+    /// Task is the task to run and Worker the number of the thread
+    /// that runs it (in [0,NumThreads)).
+    typedef void (*TaskFn)(unsigned Task, unsigned Worker, void *Data);
+
+    /// Constructor of the class.
+    WorkStealingPool(unsigned N): NumThreads(N ? N : 1){}
+    /// Destructor of the class.
+    ~WorkStealingPool(){}
+
+    inline unsigned getNumThreads() const { return NumThreads; }
+
+    /// Run Fn on each task of Tasks and return once all of them have
+    /// finished. The calling thread is the worker 0.
+    void run(const std::vector<unsigned> &Tasks, TaskFn F, void *D){
+      Fn = F;
+      Data = D;
+      for (unsigned i=0; i < NumThreads; i++)
+	Queues.push_back(new Queue());
+      for (unsigned i=0, e=Tasks.size(); i < e; i++)
+	Queues[i % NumThreads]->Tasks.push_back(Tasks[i]);
+
+      std::vector<WorkerArgs> Args(NumThreads);
+      std::vector<pthread_t> Threads(NumThreads);
+      std::vector<bool> Started(NumThreads, false);
+      for (unsigned i=1; i < NumThreads; i++){
+	Args[i].Pool = this;
+	Args[i].Id = i;
+	// If the thread cannot be created its tasks will be stolen by
+	// the others.
+	Started[i] = (pthread_create(&Threads[i], NULL, workerEntry, &Args[i]) == 0);
+      }
+      work(0);
+      for (unsigned i=1; i < NumThreads; i++){
+	if (Started[i])
+	  pthread_join(Threads[i], NULL);
+      }
+      for (unsigned i=0; i < NumThreads; i++)
+	delete Queues[i];
+      Queues.clear();
+    }
+
+  private:
+    struct Queue {
+      Mutex Lock;
+      std::deque<unsigned> Tasks;
+    };
+    struct WorkerArgs {
+      WorkerArgs(): Pool(NULL), Id(0){}
+      WorkStealingPool *Pool;
+      unsigned Id;
+    };
+
+    unsigned NumThreads;
+    std::vector<Queue*> Queues;
+    TaskFn Fn;
+    void *Data;
+
+    static void *workerEntry(void *P){
+      WorkerArgs *Args = static_cast<WorkerArgs*>(P);
+      Args->Pool->work(Args->Id);
+      return NULL;
+    }
+
+    void work(unsigned Id){
+      unsigned Task;
+      while (pop(Id, Task) || steal(Id, Task))
+	Fn(Task, Id, Data);
+    }
+
+    bool pop(unsigned Id, unsigned &Task){
+      Queue *Q = Queues[Id];
+      ScopedLock L(Q->Lock);
+      if (Q->Tasks.empty()) return false;
+      Task = Q->Tasks.front();
+      Q->Tasks.pop_front();
+      return true;
+    }
+
+    bool steal(unsigned Id, unsigned &Task){
+      for (unsigned k=1; k < NumThreads; k++){
+	Queue *Q = Queues[(Id + k) % NumThreads];
+	ScopedLock L(Q->Lock);
+	if (!Q->Tasks.empty()){
+	  Task = Q->Tasks.back();
+	  Q->Tasks.pop_back();
+	  return true;
+	}
+      }
+      return false;
+    }
+  };
+
+} // end namespace
+
+#endif /*__PARALLEL_H__*/
@@ -0,0 +1,76 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __PRIORITY_WORKLIST_H__
+#define __PRIORITY_WORKLIST_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file PriorityWorkList.h
+///       Worklist of slots ordered by slot number.
+///
+/// The fixpoint numbers blocks and instructions following a reverse
+/// post-order of the CFG so the number of an element is also its
+/// priority: the element with the smallest number is always popped
+/// first. An element is never stored twice in the worklist.
+///
+/// Compared to a std::set of pointers the order in which elements are
+/// popped does not depend on where they live in memory so the
+/// iteration order is the same from run to run.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/ADT/BitVector.h"
+
+#include <vector>
+#include <queue>
+#include <functional>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  class PriorityWorkList {
+  public:
+    /// Constructor of the class.
+    PriorityWorkList(){}
+    /// Destructor of the class.
+    ~PriorityWorkList(){}
+
+    /// Elements must be in the range [0,N).
+    inline void resize(unsigned N){
+      clear();
+      InList.resize(N);
+    }
+    /// Add Elem into the worklist. Return false if it was already there.
+    inline bool insert(unsigned Elem){
+      assert(Elem < InList.size() && "element out of range");
+      if (InList.test(Elem))
+	return false;
+      InList.set(Elem);
+      Heap.push(Elem);
+      return true;
+    }
+    /// Remove and return the element with the smallest number.
+    inline unsigned pop(){
+      assert(!empty() && "pop from an empty worklist");
+      unsigned Elem = Heap.top();
+      Heap.pop();
+      InList.reset(Elem);
+      return Elem;
+    }
+    inline bool empty() const { return Heap.empty(); }
+    inline unsigned size() const { return Heap.size(); }
+    /// Remove all the elements.
+    inline void clear(){
+      Heap = HeapTy();
+      InList.reset();
+    }
+
+  private:
+    typedef std::priority_queue<unsigned, std::vector<unsigned>,
+				std::greater<unsigned> > HeapTy;
+    HeapTy Heap;       //!< Elements ordered by number.
+    BitVector InList;  //!< To avoid duplicates.
+  };
+
+} // end namespace
+
+#endif /*__PRIORITY_WORKLIST_H__*/
@@ -0,0 +1,205 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __RESULT_CACHE_H__
+#define __RESULT_CACHE_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file ResultCache.h
+///       Content-addressed cache of results on disk.
+///
+/// Each entry is a file <key>.res in the directory of the cache,
+/// where the key is a hash of everything the results depend on, so an
+/// entry never needs to be invalidated. The header of an entry also
+/// has a second, independent hash of the same data (check) so that
+/// two keys that collide are a miss rather than the wrong
+/// results. The file "index" records the size of each entry and when it was used last. When the entries
+/// take more than the maximum size the least recently used ones are
+/// removed. The index is saved when the cache is destroyed.
+///
+/// Several threads can use the same cache. Several processes can
+/// share the directory: the entries are written through temporary
+/// files and an entry missing from the index of a process is just a
+/// miss, although the last process to finish decides the index.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Support/Parallel.h"
+#include "Support/Utils.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <string>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  class ResultCache {
+  public:
+    /// Constructor of the class. The directory Dir is created if it
+    /// does not exist. The entries take at most MaxBytes.
+    ResultCache(const std::string &_Dir, uint64_t _MaxBytes):
+      Dir(_Dir), MaxBytes(_MaxBytes), TotalSize(0), Clock(0){
+      bool Existed;
+      Enabled = !sys::fs::create_directories(Dir, Existed);
+      if (Enabled)
+	loadIndex();
+      else
+	dbgs() << "Warning: cannot create the cache directory " << Dir << "\n";
+    }
+    /// Destructor of the class.
+    ~ResultCache(){
+      if (Enabled) saveIndex();
+    }
+
+    /// If there is an entry for Key with the same Check then copy it
+    /// in Data and return true.
+    bool lookup(uint64_t Key, uint64_t Check, std::string &Data){
+      ScopedLock L(Lock);
+      std::map<uint64_t,EntryTy>::iterator It = Entries.find(Key);
+      if (!Enabled || It == Entries.end())
+	return false;
+      OwningPtr<MemoryBuffer> Buffer;
+      StringRef Contents;
+      if (!MemoryBuffer::getFile(getEntryPath(Key), Buffer))
+	Contents = Buffer->getBuffer();
+      std::string Header = getEntryHeader(Key, Check);
+      if (!Contents.startswith(Header)){
+	// Removed by another process, corrupted or a collision.
+	erase(It);
+	return false;
+      }
+      Data = Contents.substr(Header.size()).str();
+      touch(It);
+      return true;
+    }
+
+    /// Add the entry Data for Key, replacing any previous one, and
+    /// evict entries if the cache gets too big.
+    void store(uint64_t Key, uint64_t Check, StringRef Data){
+      ScopedLock L(Lock);
+      if (!Enabled) return;
+      std::string Path = getEntryPath(Key);
+      std::string Header = getEntryHeader(Key, Check);
+      std::string ErrorInfo;
+      if (!Utilities::writeFileAtomically(Path, Header + Data.str(), ErrorInfo)){
+	dbgs() << "Warning: cannot write " << Path << ": " << ErrorInfo << "\n";
+	return;
+      }
+      std::map<uint64_t,EntryTy>::iterator It = Entries.find(Key);
+      if (It != Entries.end()){
+	TotalSize -= It->second.Size;
+	LRU.erase(It->second.LastUse);
+      }
+      else
+	It = Entries.insert(std::make_pair(Key, EntryTy())).first;
+      It->second.Size = Header.size() + Data.size();
+      TotalSize += It->second.Size;
+      touch(It, false);
+      evict();
+    }
+
+  private:
+    struct EntryTy {
+      EntryTy(): Size(0), LastUse(0){}
+      uint64_t Size;
+      uint64_t LastUse;
+    };
+
+    std::string Dir;
+    uint64_t MaxBytes;
+    bool Enabled;
+    Mutex Lock;
+    std::map<uint64_t,EntryTy> Entries;
+    /// Key of the entries by time of last use.
+    std::map<uint64_t,uint64_t> LRU;
+    uint64_t TotalSize;
+    uint64_t Clock;
+
+    inline std::string getEntryPath(uint64_t Key) const {
+      return Dir + "/" + utohexstr(Key) + ".res";
+    }
+    inline std::string getIndexPath() const {
+      return Dir + "/index";
+    }
+    static inline std::string getEntryHeader(uint64_t Key, uint64_t Check){
+      return "wrapped-intervals-cache 2 " + utohexstr(Key) + " " + 
+	utohexstr(Check) + "\n";
+    }
+
+    /// Make It the most recently used entry.
+    void touch(std::map<uint64_t,EntryTy>::iterator It, bool WasInLRU = true){
+      if (WasInLRU) LRU.erase(It->second.LastUse);
+      It->second.LastUse = Clock++;
+      LRU[It->second.LastUse] = It->first;
+    }
+
+    void erase(std::map<uint64_t,EntryTy>::iterator It){
+      bool Existed;
+      sys::fs::remove(getEntryPath(It->first), Existed);
+      TotalSize -= It->second.Size;
+      LRU.erase(It->second.LastUse);
+      Entries.erase(It);
+    }
+
+    /// Remove the least recently used entries until the cache fits.
+    void evict(){
+      while (TotalSize > MaxBytes && !LRU.empty())
+	erase(Entries.find(LRU.begin()->second));
+    }
+
+    /// The index has a line per entry: key, size and time of last
+    /// use, in hexadecimal.
+    void loadIndex(){
+      OwningPtr<MemoryBuffer> Buffer;
+      if (MemoryBuffer::getFile(getIndexPath(), Buffer))
+	return;
+      SmallVector<StringRef, 256> Lines;
+      Buffer->getBuffer().split(Lines, "\n", -1, false);
+      for (unsigned i=0, e=Lines.size(); i < e; i++){
+	StringRef Line = Lines[i];
+	uint64_t Key, Size, LastUse;
+	if (!Utilities::readHex(Line, Key) || !Utilities::readHex(Line, Size) ||
+	    !Utilities::readHex(Line, LastUse) || Entries.count(Key) ||
+	    LRU.count(LastUse))
+	  continue;
+	EntryTy &E = Entries[Key];
+	E.Size = Size;
+	E.LastUse = LastUse;
+	LRU[LastUse] = Key;
+	TotalSize += Size;
+	if (LastUse >= Clock) Clock = LastUse + 1;
+      }
+      evict();
+    }
+
+    void saveIndex(){
+      std::string Path = getIndexPath();
+      std::string Index;
+      {
+	raw_string_ostream Out(Index);
+	for (std::map<uint64_t,EntryTy>::iterator
+	       I = Entries.begin(), E = Entries.end(); I != E; ++I)
+	  Out << utohexstr(I->first) << " " << utohexstr(I->second.Size) << " "
+	      << utohexstr(I->second.LastUse) << "\n";
+      }
+      std::string ErrorInfo;
+      if (!Utilities::writeFileAtomically(Path, Index, ErrorInfo))
+	dbgs() << "Warning: cannot write " << Path << ": " << ErrorInfo << "\n";
+    }
+
+    // Not copyable
+    ResultCache(const ResultCache&);
+    void operator=(const ResultCache&);
+  };
+
+} // end namespace
+
+#endif /*__RESULT_CACHE_H__*/
@@ -0,0 +1,493 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __RESULT_STORE_H__
+#define __RESULT_STORE_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file ResultStore.h
+///       Binary file with the final results of the analysis of a module.
+///
+/// The file is meant to be mapped in memory and read in place:
+///
+/// \verbatim
+///   header
+///   function table    one entry per function sorted by Index
+///   per function      reachability bitmap (32-bit words),
+///                     feasible edges sorted by (From,To) and
+///                     values sorted by Key (8-byte aligned)
+///   strings           NUL-terminated names
+/// \endverbatim
+///
+/// All the integers are little-endian. A function is identified by
+/// its position in the module (Index), a block by its position in its
+/// function and a value by its Key: the number of an argument or the
+/// number of arguments plus the position of an instruction in its
+/// function. Blocks, edges and values are in the same order as in
+/// the IR so the keys are stable as long as the IR does not change.
+/// Only the values that the analysis keeps track of are stored.
+///
+/// Bounds are stored as unsigned integers of at most 64 bits (as in
+/// the warm-start snapshots). A wrapped interval may have Lo > Hi.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Support/Parallel.h"
+#include "Support/Utils.h"
+#include "llvm/Module.h"
+#include "llvm/Function.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  /// Version of the format. Readers reject any other version.
+  const unsigned ResultStoreVersion = 1;
+  const char ResultStoreMagic[8] = {'W','R','A','P','R','E','S','\0'};
+
+  /// Kind of a stored value.
+  enum ResultKindTy { RESULT_BOTTOM=0, RESULT_TOP=1, RESULT_RANGE=2,
+		      RESULT_FLAG=3 };
+
+  struct ResultStoreHeader {
+    char                 Magic[8];
+    support::ulittle32_t Version;
+    support::ulittle32_t NumFunctions;
+    support::ulittle64_t FunctionsOffset;
+    support::ulittle64_t StringsOffset;
+    support::ulittle64_t StringsSize;
+    support::ulittle32_t AnalysisName;  //!< Offset into the strings.
+    support::ulittle32_t Reserved;
+  };
+
+  struct ResultStoreFunction {
+    support::ulittle32_t Index;         //!< Position in the module.
+    support::ulittle32_t Name;          //!< Offset into the strings.
+    support::ulittle32_t NumBlocks;
+    support::ulittle32_t NumEdges;
+    support::ulittle32_t NumValues;
+    support::ulittle32_t Reserved;
+    support::ulittle64_t BlocksOffset;
+    support::ulittle64_t EdgesOffset;
+    support::ulittle64_t ValuesOffset;
+  };
+
+  struct ResultStoreEdge {
+    support::ulittle32_t From;
+    support::ulittle32_t To;
+  };
+
+  struct ResultStoreValue {
+    support::ulittle32_t Key;
+    support::ulittle16_t Width;
+    uint8_t              Kind;          //!< ResultKindTy
+    uint8_t              Reserved;
+    /// Bounds if Kind is RESULT_RANGE. If it is RESULT_FLAG then Lo
+    /// holds the bits of the TBool (see TBool::getBits).
+    support::ulittle64_t Lo;
+    support::ulittle64_t Hi;
+  };
+
+  /// Collect the results of the analyzed functions and write them at
+  /// the end. Several threads can add results at the same time.
+  class ResultStoreWriter {
+  public:
+    struct ValueResult {
+      ValueResult(unsigned _Key, unsigned _Width, ResultKindTy _Kind,
+		  uint64_t _Lo, uint64_t _Hi):
+	Key(_Key), Width(_Width), Kind(_Kind), Lo(_Lo), Hi(_Hi){}
+      unsigned Key, Width;
+      ResultKindTy Kind;
+      uint64_t Lo, Hi;
+    };
+    struct FunctionResults {
+      FunctionResults(): NumBlocks(0){}
+      std::string Name;
+      unsigned NumBlocks;
+      std::vector<uint32_t> Reachable;  //!< Bitmap of the blocks.
+      std::vector<std::pair<unsigned,unsigned> > Edges;
+      std::vector<ValueResult> Values;
+      inline void setNumBlocks(unsigned N){
+	NumBlocks = N;
+	Reachable.assign((N + 31) / 32, 0);
+      }
+      inline void setReachable(unsigned B){
+	Reachable[B / 32] |= ((uint32_t) 1) << (B % 32);
+      }
+    };
+
+    /// Constructor of the class. Functions are numbered by their
+    /// position in M.
+    ResultStoreWriter(Module *M, StringRef Name): AnalysisName(Name){
+      unsigned i=0;
+      for (Module::iterator F = M->begin(), E = M->end(); F != E; ++F, ++i)
+	FunctionIndex[F] = i;
+    }
+    /// Destructor of the class.
+    ~ResultStoreWriter(){
+      for (std::map<unsigned,FunctionResults*>::iterator
+	     I = Results.begin(), E = Results.end(); I != E; ++I)
+	delete I->second;
+    }
+
+    /// Record the results R of F, which the writer now owns. They
+    /// replace any previous results of F.
+    void add(Function *F, FunctionResults *R){
+      std::sort(R->Edges.begin(), R->Edges.end());
+      R->Edges.erase(std::unique(R->Edges.begin(), R->Edges.end()), R->Edges.end());
+      unsigned Index = FunctionIndex.lookup(F);
+      ScopedLock L(Lock);
+      FunctionResults *&Old = Results[Index];
+      delete Old;
+      Old = R;
+    }
+
+    /// Print the results of F in a single line of hexadecimal numbers
+    /// (see decode). Return false if F has no results.
+    bool encode(Function *F, raw_ostream &Out){
+      unsigned Index = FunctionIndex.lookup(F);
+      ScopedLock L(Lock);
+      std::map<unsigned,FunctionResults*>::iterator It = Results.find(Index);
+      if (It == Results.end()) return false;
+      FunctionResults *R = It->second;
+      Out << utohexstr(R->NumBlocks);
+      for (unsigned k=0, e=R->Reachable.size(); k < e; k++)
+	Out << " " << utohexstr(R->Reachable[k]);
+      Out << " " << utohexstr(R->Edges.size());
+      for (unsigned k=0, e=R->Edges.size(); k < e; k++)
+	Out << " " << utohexstr(R->Edges[k].first)
+	    << " " << utohexstr(R->Edges[k].second);
+      Out << " " << utohexstr(R->Values.size());
+      for (unsigned k=0, e=R->Values.size(); k < e; k++){
+	const ValueResult &V = R->Values[k];
+	Out << " " << utohexstr(V.Key) << " " << utohexstr(V.Width)
+	    << " " << utohexstr(V.Kind) << " " << utohexstr(V.Lo)
+	    << " " << utohexstr(V.Hi);
+      }
+      Out << "\n";
+      return true;
+    }
+
+    /// Record the results of F printed by encode. Return false and
+    /// record nothing if Str is not well-formed.
+    bool decode(Function *F, StringRef Str){
+      if (Str.endswith("\n"))
+	Str = Str.substr(0, Str.size() - 1);
+      // Each number takes at least two characters so the counts are
+      // bounded before anything is allocated.
+      uint64_t N, X, Y;
+      OwningPtr<FunctionResults> R(new FunctionResults());
+      R->Name = F->getName();
+      if (!Utilities::readHex(Str, N) || (N + 31) / 32 > Str.size())
+	return false;
+      R->setNumBlocks(N);
+      for (unsigned k=0, e=R->Reachable.size(); k < e; k++){
+	if (!Utilities::readHex(Str, X)) return false;
+	R->Reachable[k] = X;
+      }
+      if (!Utilities::readHex(Str, N) || N > Str.size())
+	return false;
+      for (unsigned k=0; k < N; k++){
+	if (!Utilities::readHex(Str, X) || !Utilities::readHex(Str, Y))
+	  return false;
+	R->Edges.push_back(std::make_pair((unsigned) X, (unsigned) Y));
+      }
+      if (!Utilities::readHex(Str, N) || N > Str.size())
+	return false;
+      for (unsigned k=0; k < N; k++){
+	uint64_t Key, Width, Kind, Lo, Hi;
+	if (!Utilities::readHex(Str, Key) || !Utilities::readHex(Str, Width) ||
+	    !Utilities::readHex(Str, Kind) || !Utilities::readHex(Str, Lo) ||
+	    !Utilities::readHex(Str, Hi) || Kind > RESULT_FLAG)
+	  return false;
+	R->Values.push_back(ValueResult(Key, Width, (ResultKindTy) Kind, Lo, Hi));
+      }
+      if (!Str.empty()) return false;
+      add(F, R.take());
+      return true;
+    }
+
+    /// Write the file Path (see Utilities::writeFileAtomically).
+    /// Return false if it cannot be written.
+    bool write(const std::string &Path, std::string &ErrorInfo){
+      ScopedLock L(Lock);
+      std::string Strings;
+      unsigned AnalysisNameOffset = addString(Strings, AnalysisName);
+      std::vector<unsigned> Names;
+      for (std::map<unsigned,FunctionResults*>::iterator
+	     I = Results.begin(), E = Results.end(); I != E; ++I)
+	Names.push_back(addString(Strings, I->second->Name));
+
+      // Offsets of each section.
+      uint64_t Offset = sizeof(ResultStoreHeader);
+      uint64_t FunctionsOffset = Offset;
+      Offset += Results.size() * sizeof(ResultStoreFunction);
+      std::vector<uint64_t> Blocks, Edges, Values;
+      for (std::map<unsigned,FunctionResults*>::iterator
+	     I = Results.begin(), E = Results.end(); I != E; ++I){
+	FunctionResults *R = I->second;
+	Blocks.push_back(Offset);
+	Offset += R->Reachable.size() * sizeof(uint32_t);
+	Edges.push_back(Offset);
+	Offset += R->Edges.size() * sizeof(ResultStoreEdge);
+	Offset = alignTo8(Offset);
+	Values.push_back(Offset);
+	Offset += R->Values.size() * sizeof(ResultStoreValue);
+      }
+      uint64_t StringsOffset = Offset;
+
+      std::string Data;
+      {
+	raw_string_ostream Out(Data);
+	ResultStoreHeader H;
+	memset(&H, 0, sizeof(H));
+	memcpy(H.Magic, ResultStoreMagic, sizeof(H.Magic));
+	H.Version = ResultStoreVersion;
+	H.NumFunctions = Results.size();
+	H.FunctionsOffset = FunctionsOffset;
+	H.StringsOffset = StringsOffset;
+	H.StringsSize = Strings.size();
+	H.AnalysisName = AnalysisNameOffset;
+	Out.write(reinterpret_cast<const char*>(&H), sizeof(H));
+
+	unsigned i=0;
+	for (std::map<unsigned,FunctionResults*>::iterator
+	       I = Results.begin(), E = Results.end(); I != E; ++I, ++i){
+	  FunctionResults *R = I->second;
+	  ResultStoreFunction F;
+	  memset(&F, 0, sizeof(F));
+	  F.Index = I->first;
+	  F.Name = Names[i];
+	  F.NumBlocks = R->NumBlocks;
+	  F.NumEdges = R->Edges.size();
+	  F.NumValues = R->Values.size();
+	  F.BlocksOffset = Blocks[i];
+	  F.EdgesOffset = Edges[i];
+	  F.ValuesOffset = Values[i];
+	  Out.write(reinterpret_cast<const char*>(&F), sizeof(F));
+	}
+
+	uint64_t Pos = FunctionsOffset + Results.size() * sizeof(ResultStoreFunction);
+	for (std::map<unsigned,FunctionResults*>::iterator
+	       I = Results.begin(), E = Results.end(); I != E; ++I){
+	  FunctionResults *R = I->second;
+	  for (unsigned k=0, e=R->Reachable.size(); k < e; k++){
+	    support::ulittle32_t W;
+	    W = R->Reachable[k];
+	    Out.write(reinterpret_cast<const char*>(&W), sizeof(W));
+	  }
+	  Pos += R->Reachable.size() * sizeof(uint32_t);
+	  for (unsigned k=0, e=R->Edges.size(); k < e; k++){
+	    ResultStoreEdge Edge;
+	    Edge.From = R->Edges[k].first;
+	    Edge.To = R->Edges[k].second;
+	    Out.write(reinterpret_cast<const char*>(&Edge), sizeof(Edge));
+	  }
+	  Pos += R->Edges.size() * sizeof(ResultStoreEdge);
+	  for (; Pos < alignTo8(Pos); Pos++)
+	    Out << '\0';
+	  for (unsigned k=0, e=R->Values.size(); k < e; k++){
+	    const ValueResult &V = R->Values[k];
+	    ResultStoreValue SV;
+	    memset(&SV, 0, sizeof(SV));
+	    SV.Key = V.Key;
+	    SV.Width = V.Width;
+	    SV.Kind = V.Kind;
+	    SV.Lo = V.Lo;
+	    SV.Hi = V.Hi;
+	    Out.write(reinterpret_cast<const char*>(&SV), sizeof(SV));
+	  }
+	  Pos += R->Values.size() * sizeof(ResultStoreValue);
+	}
+	assert(Pos == StringsOffset);
+	Out << Strings;
+      }
+      return Utilities::writeFileAtomically(Path, Data, ErrorInfo);
+    }
+
+  private:
+    std::string AnalysisName;
+    DenseMap<Function*,unsigned> FunctionIndex;
+    Mutex Lock;
+    /// Results of each function by Index.
+    std::map<unsigned,FunctionResults*> Results;
+
+    static inline uint64_t alignTo8(uint64_t X){ return (X + 7) & ~((uint64_t) 7); }
+    static unsigned addString(std::string &Strings, StringRef S){
+      unsigned Offset = Strings.size();
+      Strings.append(S.begin(), S.end());
+      Strings.push_back('\0');
+      return Offset;
+    }
+  };
+
+  /// Read a file written by ResultStoreWriter. The file is mapped in
+  /// memory and all the queries read it in place.
+  class ResultStoreReader {
+  public:
+    /// Constructor of the class.
+    ResultStoreReader(){}
+    /// Destructor of the class.
+    ~ResultStoreReader(){}
+
+    /// Map the file Path and check that it is a well-formed result
+    /// store of the current version. Return false otherwise.
+    bool open(const std::string &Path, std::string &ErrorInfo){
+      Buffer.reset();
+      if (error_code EC = MemoryBuffer::getFile(Path, Buffer, -1, false)){
+	ErrorInfo = EC.message();
+	return false;
+      }
+      if (!check()){
+	Buffer.reset();
+	ErrorInfo = Path + ": not a result store of version " +
+	  utostr(ResultStoreVersion);
+	return false;
+      }
+      return true;
+    }
+
+    inline StringRef getAnalysisName() const {
+      return getString(getHeader()->AnalysisName);
+    }
+    inline unsigned getNumFunctions() const {
+      return getHeader()->NumFunctions;
+    }
+    /// Return the i-th function of the table (they are sorted by Index).
+    inline const ResultStoreFunction* getFunction(unsigned i) const {
+      return getFunctions() + i;
+    }
+    /// Return the function at position Index of the module or NULL.
+    const ResultStoreFunction* lookupFunction(unsigned Index) const {
+      const ResultStoreFunction *Fs = getFunctions();
+      unsigned Lo = 0, Hi = getNumFunctions();
+      while (Lo < Hi){
+	unsigned Mid = Lo + (Hi - Lo) / 2;
+	unsigned MidIndex = Fs[Mid].Index;
+	if (MidIndex == Index) return Fs + Mid;
+	if (MidIndex < Index) Lo = Mid + 1;
+	else Hi = Mid;
+      }
+      return NULL;
+    }
+    /// Return the function named Name or NULL.
+    const ResultStoreFunction* lookupFunction(StringRef Name) const {
+      for (unsigned i=0, e=getNumFunctions(); i < e; i++){
+	if (getName(getFunction(i)) == Name)
+	  return getFunction(i);
+      }
+      return NULL;
+    }
+    inline StringRef getName(const ResultStoreFunction *F) const {
+      return getString(F->Name);
+    }
+
+    /// Return true if the block B of F is reachable.
+    inline bool isReachable(const ResultStoreFunction *F, unsigned B) const {
+      if (B >= F->NumBlocks) return false;
+      const support::ulittle32_t *Words =
+	reinterpret_cast<const support::ulittle32_t*>(getBase() + F->BlocksOffset);
+      return (Words[B / 32] >> (B % 32)) & 1;
+    }
+    /// Return true if the edge between the blocks From and To of F is
+    /// feasible.
+    bool isEdgeFeasible(const ResultStoreFunction *F, unsigned From, unsigned To) const {
+      const ResultStoreEdge *Edges =
+	reinterpret_cast<const ResultStoreEdge*>(getBase() + F->EdgesOffset);
+      std::pair<unsigned,unsigned> Key(From, To);
+      unsigned Lo = 0, Hi = F->NumEdges;
+      while (Lo < Hi){
+	unsigned Mid = Lo + (Hi - Lo) / 2;
+	std::pair<unsigned,unsigned> MidKey(Edges[Mid].From, Edges[Mid].To);
+	if (MidKey == Key) return true;
+	if (MidKey < Key) Lo = Mid + 1;
+	else Hi = Mid;
+      }
+      return false;
+    }
+    /// Return the value of F with key Key or NULL if it is not
+    /// tracked.
+    const ResultStoreValue* lookupValue(const ResultStoreFunction *F, unsigned Key) const {
+      const ResultStoreValue *Values =
+	reinterpret_cast<const ResultStoreValue*>(getBase() + F->ValuesOffset);
+      unsigned Lo = 0, Hi = F->NumValues;
+      while (Lo < Hi){
+	unsigned Mid = Lo + (Hi - Lo) / 2;
+	unsigned MidKey = Values[Mid].Key;
+	if (MidKey == Key) return Values + Mid;
+	if (MidKey < Key) Lo = Mid + 1;
+	else Hi = Mid;
+      }
+      return NULL;
+    }
+
+  private:
+    OwningPtr<MemoryBuffer> Buffer;
+
+    inline const char* getBase() const { return Buffer->getBufferStart(); }
+    inline const ResultStoreHeader* getHeader() const {
+      return reinterpret_cast<const ResultStoreHeader*>(getBase());
+    }
+    inline const ResultStoreFunction* getFunctions() const {
+      return reinterpret_cast<const ResultStoreFunction*>
+	(getBase() + getHeader()->FunctionsOffset);
+    }
+    inline StringRef getString(unsigned Offset) const {
+      return StringRef(getBase() + getHeader()->StringsOffset + Offset);
+    }
+
+    /// Return true if [Offset,Offset+Size) is inside the file.
+    inline bool inBounds(uint64_t Offset, uint64_t Size) const {
+      uint64_t FileSize = Buffer->getBufferSize();
+      return Offset <= FileSize && Size <= FileSize - Offset;
+    }
+
+    /// Check the header and that every section is inside the file so
+    /// that the queries need no checks.
+    bool check() const {
+      if (!inBounds(0, sizeof(ResultStoreHeader))) return false;
+      const ResultStoreHeader *H = getHeader();
+      if (memcmp(H->Magic, ResultStoreMagic, sizeof(H->Magic)) ||
+	  H->Version != ResultStoreVersion)
+	return false;
+      // The strings must end with a NUL.
+      uint64_t StringsOffset = H->StringsOffset;
+      uint64_t StringsSize = H->StringsSize;
+      if (!inBounds(StringsOffset, StringsSize) || StringsSize == 0 ||
+	  getBase()[StringsOffset + StringsSize - 1] != '\0' ||
+	  (uint64_t) H->AnalysisName >= StringsSize)
+	return false;
+      uint64_t NumFunctions = H->NumFunctions;
+      if (!inBounds(H->FunctionsOffset, NumFunctions * sizeof(ResultStoreFunction)))
+	return false;
+      for (unsigned i=0; i < NumFunctions; i++){
+	const ResultStoreFunction *F = getFunction(i);
+	uint64_t NumBlocks = F->NumBlocks;
+	uint64_t NumEdges = F->NumEdges;
+	uint64_t NumValues = F->NumValues;
+	if ((uint64_t) F->Name >= StringsSize ||
+	    !inBounds(F->BlocksOffset, ((NumBlocks + 31) / 32) * sizeof(uint32_t)) ||
+	    !inBounds(F->EdgesOffset, NumEdges * sizeof(ResultStoreEdge)) ||
+	    !inBounds(F->ValuesOffset, NumValues * sizeof(ResultStoreValue)))
+	  return false;
+      }
+      return true;
+    }
+  };
+
+} // end namespace
+
+#endif /*__RESULT_STORE_H__*/
@@ -21,35 +21,55 @@ namespace unimelb{
     ~TBool(){}
     
     /// Return true if the Boolean value is true.
-    inline bool isTrue()  { return (flag == TTRUE);}
+    inline bool isTrue()   const { return (flag == TTRUE);}
     /// Return true if the Boolean value is false.
-    inline bool isFalse() { return (flag == TFALSE); }
+    inline bool isFalse()  const { return (flag == TFALSE); }
     /// Return true if the Boolean value is undefined.
-    inline bool isMaybe() { return (flag == TUNDEF); } 
+    inline bool isMaybe()  const { return (flag == TUNDEF); } 
     /// Return true if the Boolean value is bottom.
-    inline bool isBottom(){ return (flag == TBOT); } 
+    inline bool isBottom() const { return (flag == TBOT); } 
     /// Convert the Boolean value to a string.
-    inline std::string getValue(){
+    inline std::string getValue() const {
       if (flag == TTRUE)  return "true";
       if (flag == TFALSE) return "false";
       if (flag == TBOT)   return "bottom";
       return "*";      
     }
     /// Print the Boolean value.
-    inline void print(llvm::raw_ostream &Out){
+    inline void print(llvm::raw_ostream &Out) const {
       Out << getValue();
     }
+
+    /// The value encoded in two bits (to store flags packed).
+    inline unsigned getBits() const { return flag; }
+    /// Build the value from its encoding in two bits.
+    static inline TBool fromBits(unsigned Bits){
+      TBool B;
+      B.flag = (TBoolValue) (Bits & 3);
+      return B;
+    }
     
     /// Return if this and newF are equal.
-    inline bool isEqual(TBool * newF){
-      if ( (isTrue()  && newF->isTrue())  || 
-	   (isFalse() && newF->isFalse()) ||
-	   (isMaybe() && newF->isMaybe()) ||
-	   (isBottom() && newF->isBottom()))
-	return true;
-      return false;
+    inline bool isEqual(const TBool &newF) const {
+      return (flag == newF.flag);
     }
+    inline bool isEqual(const TBool *newF) const { return isEqual(*newF); }
     
+    /// Return true if this is at least as precise as newF, where
+    /// bottom < true, false < maybe.
+    inline bool lessOrEqual(const TBool &newF) const {
+      return (isBottom() || newF.isMaybe() || isEqual(newF));
+    }
+    inline bool lessOrEqual(const TBool *newF) const { return lessOrEqual(*newF); }
+
+    /// Least upper bound of this and F.
+    inline void join(const TBool &F){
+      if (F.isBottom() || isEqual(F)) return;
+      if (isBottom()) flag = F.flag;
+      else makeMaybe();
+    }
+    inline void join(const TBool *F){ join(*F); }
+
     /// Make this true.
     inline void makeTrue()  {flag=TTRUE;}
     /// Make this false.
@@ -58,6 +78,9 @@ namespace unimelb{
     inline void makeMaybe() {flag=TUNDEF;}
     /// Make this bottom.
     inline void makeBottom(){flag=TBOT;}
+
+    // The logical operations are looked up in a table indexed by the
+    // encodings of both operands (bottom if any of them is bottom).
     
     /// And operation between F1 and F2.
     ///
@@ -68,33 +91,15 @@ namespace unimelb{
     ///  1 | 0  1  U    
     ///  U | 0  U  U    
     /// \endverbatim
-    void And(TBool * F1, TBool * F2){
-      if (F1->isBottom() || F2->isBottom()){
-	makeBottom();
-	return;
-      }
-      
-      if (F1->isFalse()) 
-	makeFalse();
-      else{
-      if (F1->isTrue()){
-	if (F2->isFalse())
-	  makeFalse();
-	else{
-	  if (F2->isTrue()) 
-	    makeTrue();
-	  else 
-	    makeMaybe();
-	}
-      }
-      else{
-	if (F2->isFalse()) 
-	  makeFalse();
-	else 
-	  makeMaybe();
-      }
-      }      
+    inline void And(const TBool &F1, const TBool &F2){
+      static const unsigned char Table[16] = {
+	TFALSE, TFALSE, TFALSE, TBOT,
+	TFALSE, TTRUE,  TUNDEF, TBOT,
+	TFALSE, TUNDEF, TUNDEF, TBOT,
+	TBOT,   TBOT,   TBOT,   TBOT };
+      flag = (TBoolValue) Table[(F1.flag << 2) | F2.flag];
     }
+    inline void And(const TBool *F1, const TBool *F2){ And(*F1, *F2); }
     
     /// Or operation between F1 and F2.
     ///
@@ -105,33 +110,15 @@ namespace unimelb{
     ///  1 | 1  1  1
     ///  U | U  1  U
     /// \endverbatim
-    void Or(TBool * F1, TBool * F2){
-      if (F1->isBottom() || F2->isBottom()){
-	makeBottom();
-	return;
-      }
-
-      if (F1->isTrue()) 
-	makeTrue();
-      else{
-	if (F1->isFalse()){
-	  if (F2->isFalse()) 
-	    makeFalse();
-	  else{
-	    if (F2->isTrue()) 
-	      makeTrue();
-	    else 
-	      makeMaybe();
-	  }
-	}
-	else{
-	  if (F2->isTrue()) 
-	    makeTrue();
-	  else 
-	    makeMaybe();
-	}
-      }
+    inline void Or(const TBool &F1, const TBool &F2){
+      static const unsigned char Table[16] = {
+	TFALSE, TTRUE,  TUNDEF, TBOT,
+	TTRUE,  TTRUE,  TTRUE,  TBOT,
+	TUNDEF, TTRUE,  TUNDEF, TBOT,
+	TBOT,   TBOT,   TBOT,   TBOT };
+      flag = (TBoolValue) Table[(F1.flag << 2) | F2.flag];
     }
+    inline void Or(const TBool *F1, const TBool *F2){ Or(*F1, *F2); }
 
     /// Xor operation between F1 and F2.
     ///
@@ -142,22 +129,15 @@ namespace unimelb{
     ///  1 | 1  0  U
     ///  U | U  U  U  
     /// \endverbatim
-    void Xor(TBool * F1, TBool * F2){
-      if (F1->isBottom() || F2->isBottom()){
-	makeBottom();
-	return;
-      }
-
-      if (F1->isMaybe() || F2->isMaybe())
-	makeMaybe();
-      else{
-	if ( (F1->isTrue() && F2->isFalse()) || 
-	     (F1->isFalse() && F2->isTrue()))
-	  makeTrue();
-	else
-	  makeFalse();
-      }
+    inline void Xor(const TBool &F1, const TBool &F2){
+      static const unsigned char Table[16] = {
+	TFALSE, TTRUE,  TUNDEF, TBOT,
+	TTRUE,  TFALSE, TUNDEF, TBOT,
+	TUNDEF, TUNDEF, TUNDEF, TBOT,
+	TBOT,   TBOT,   TBOT,   TBOT };
+      flag = (TBoolValue) Table[(F1.flag << 2) | F2.flag];
     }
+    inline void Xor(const TBool *F1, const TBool *F2){ Xor(*F1, *F2); }
 
   private:
     typedef enum {TFALSE = 0, TTRUE = 1, TUNDEF=2, TBOT=3} TBoolValue;
@@ -15,9 +15,12 @@
 #include "llvm/Instructions.h"
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InstIterator.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <set>
+#include <string>
 
 using namespace llvm;
 
@@ -168,11 +171,18 @@ namespace unimelb {
 
     ///  Record constants that appear in the program
     static void recordIntegerConstants(Function *F, std::set<int64_t> &ConstSet){
+      recordCommonBounds(ConstSet);
+      for (inst_iterator I = inst_begin(F), E=inst_end(F) ; I != E; ++I)
+	recordIntegerConstants(&*I, ConstSet);
+    }
+
+    /// Record the minimum and maximum values for unsigned and signed
+    /// versions of common widths (8,16, and 32).
+    static void recordCommonBounds(std::set<int64_t> &ConstSet){
       //////////////////////////////////////////////////////////////////////////////
-      // We also insert the maximum and minimum values for unsigned and
-      // signed versions for common widths (8,16, and 32). This is
-      // important for domains like WrappedRangeLattice in order to avoid
-      // widening to jump too much when the intervals wraparound.
+      // This is important for domains like WrappedRangeLattice in
+      // order to avoid widening to jump too much when the intervals
+      // wraparound.
       //////////////////////////////////////////////////////////////////////////////
       int64_t umin8  = APInt::getMinValue(8).getZExtValue();
       int64_t smin8  = APInt::getSignedMinValue(8).getSExtValue();
@@ -193,21 +203,22 @@ namespace unimelb {
       ConstSet.insert(smin16); ConstSet.insert(smax16); 
       ConstSet.insert(umin32); ConstSet.insert(umax32);
       ConstSet.insert(smin32); ConstSet.insert(smax32);
-      
-      for (inst_iterator I = inst_begin(F), E=inst_end(F) ; I != E; ++I){
-	for (User::op_iterator i = I->op_begin(), e = I->op_end(); i != e; ++i){
-	  if (ConstantInt *C = dyn_cast<ConstantInt>(*i)){
-	    unsigned width;
-	    if (Utilities::getIntegerWidth(C->getType(),width)){
-	      if (width <= 64){ // Programs like susan has i288 constants!
-		ConstSet.insert(convertConstantIntToint64_t(C)-1);
-		ConstSet.insert(convertConstantIntToint64_t(C));
-		ConstSet.insert(convertConstantIntToint64_t(C)+1);
-	      }
+    }
+
+    /// Record c-1, c and c+1 for each integer constant c used by I.
+    static void recordIntegerConstants(Instruction *I, std::set<int64_t> &ConstSet){
+      for (User::op_iterator i = I->op_begin(), e = I->op_end(); i != e; ++i){
+	if (ConstantInt *C = dyn_cast<ConstantInt>(*i)){
+	  unsigned width;
+	  if (Utilities::getIntegerWidth(C->getType(),width)){
+	    if (width <= 64){ // Programs like susan has i288 constants!
+	      ConstSet.insert(convertConstantIntToint64_t(C)-1);
+	      ConstSet.insert(convertConstantIntToint64_t(C));
+	      ConstSet.insert(convertConstantIntToint64_t(C)+1);
 	    }
 	  }
-	} // end for
-      } // end for      
+	}
+      } // end for
     }
 
     // For debugging
@@ -234,6 +245,52 @@ namespace unimelb {
       else if ( !IsPositive_x && IsPositive_y) return false;
       else return x < y;
     }
+
+    // Parsing of the textual files written by the analysis (e.g.,
+    // warm-start snapshots).
+
+    /// Remove the first space-separated token of Str and return it.
+    static StringRef nextToken(StringRef &Str){
+      std::pair<StringRef,StringRef> P = Str.split(' ');
+      Str = P.second;
+      return P.first;
+    }
+    /// Read the next token of Str as an hexadecimal number. Return
+    /// false if it is not.
+    static bool readHex(StringRef &Str, uint64_t &V){
+      // getAsInteger returns true on error. It takes an unsigned long
+      // long which is not uint64_t on every host.
+      unsigned long long X;
+      if (nextToken(Str).getAsInteger(16, X)) return false;
+      V = X;
+      return true;
+    }
+
+    /// Write Data in the file Path. It is written first in a
+    /// temporary file which is then renamed so that a reader never
+    /// sees a partial file. Return false (with the reason in
+    /// ErrorInfo) if it cannot be written.
+    static bool writeFileAtomically(const std::string &Path, StringRef Data,
+				    std::string &ErrorInfo){
+      std::string TmpPath = Path + ".tmp";
+      {
+	raw_fd_ostream Out(TmpPath.c_str(), ErrorInfo, raw_fd_ostream::F_Binary);
+	if (!ErrorInfo.empty())
+	  return false;
+	Out << Data;
+	Out.close();
+	if (Out.has_error()){
+	  Out.clear_error();
+	  ErrorInfo = "cannot write " + TmpPath;
+	  return false;
+	}
+      }
+      if (error_code EC = sys::fs::rename(TmpPath, Path)){
+	ErrorInfo = EC.message();
+	return false;
+      }
+      return true;
+    }
   
 
   };
@@ -0,0 +1,202 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __WTO_H__
+#define __WTO_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file WTO.h
+///       Weak topological ordering of the CFG of a function.
+///
+/// Implementation of the algorithm described in "Efficient chaotic
+/// iteration strategies with widenings" (F. Bourdoncle, FMPA'93).
+///
+/// A weak topological ordering (WTO) is a hierarchical decomposition
+/// of the CFG into nested components, e.g.:
+///
+/// \verbatim
+///   1 2 (3 4 (5 6) 7) 8
+/// \endverbatim
+///
+/// where each component is written between parenthesis and its first
+/// element is the head of the component. Every cycle of the CFG goes
+/// through the head of some component that contains it so the heads
+/// form a set of widening points.
+///
+/// The WTO is stored as a flat sequence of nodes. A node which is the
+/// head of a component knows the size of the component (head
+/// included) so that the elements of the component are the
+/// consecutive nodes that follow it.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "llvm/Function.h"
+#include "llvm/BasicBlock.h"
+#include "llvm/InstrTypes.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/DenseMap.h"
+
+#include <vector>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  class WeakTopologicalOrder {
+  public:
+    /// Element of the WTO.
+    struct Node {
+      Node(BasicBlock *_BB, bool _IsHead):
+	BB(_BB), IsHead(_IsHead), Size(1){}
+      BasicBlock *BB;
+      /// True if the node is the head of a component.
+      bool IsHead;
+      /// Number of nodes of the component including the head. 1 if
+      /// the node is not a head.
+      unsigned Size;
+    };
+    typedef std::vector<Node>::const_iterator iterator;
+
+    /// Constructor of the class. Compute the WTO of the blocks of F
+    /// reachable from its entry block.
+    WeakTopologicalOrder(Function *F): Num(0){
+      Partition P;
+      build(&F->getEntryBlock(), P);
+      flatten(P, Nodes);
+      DFN.clear();
+      Stack.clear();
+    }
+    /// Destructor of the class.
+    ~WeakTopologicalOrder(){}
+
+    inline iterator begin() const { return Nodes.begin(); }
+    inline iterator end()   const { return Nodes.end(); }
+    inline unsigned size()  const { return Nodes.size(); }
+    inline const Node& operator[](unsigned i) const { return Nodes[i]; }
+
+    void print(raw_ostream &Out) const {
+      std::vector<unsigned> Ends;
+      for (unsigned i=0; i < Nodes.size(); i++){
+	if (Nodes[i].IsHead){
+	  Out << "(";
+	  Ends.push_back(i + Nodes[i].Size);
+	}
+	Out << Nodes[i].BB->getName();
+	while (!Ends.empty() && Ends.back() == i+1){
+	  Out << ")";
+	  Ends.pop_back();
+	}
+	Out << " ";
+      }
+      Out << "\n";
+    }
+
+  private:
+    /// A partition is kept as a sequence of chunks in reverse order
+    /// since the algorithm builds it by prepending elements.
+    typedef std::vector<std::vector<Node> > Partition;
+
+    std::vector<Node> Nodes;
+    DenseMap<BasicBlock*, unsigned> DFN;
+    std::vector<BasicBlock*> Stack;
+    unsigned Num;
+
+    inline unsigned getDFN(BasicBlock *BB) const {
+      DenseMap<BasicBlock*, unsigned>::const_iterator It = DFN.find(BB);
+      if (It == DFN.end()) return 0;
+      return It->second;
+    }
+
+    /// A call of the recursive algorithm of Bourdoncle: either
+    /// visit(V,P) or, once visit finds that V is the head of a
+    /// component, component(V,P). Succ is the next successor of V to
+    /// be considered.
+    struct Frame {
+      Frame(BasicBlock *_V, Partition *_P, unsigned _Head): 
+	V(_V), P(_P), Body(NULL), Succ(0), Head(_Head), Loop(false){}
+      BasicBlock *V;
+      Partition *P;
+      /// Partition of the body of the component (NULL during visit).
+      Partition *Body;
+      unsigned Succ;
+      unsigned Head;
+      bool Loop;
+    };
+
+    /// Start visit(V,P).
+    void pushVisit(std::vector<Frame> &Frames, BasicBlock *V, Partition *P){
+      Stack.push_back(V);
+      DFN[V] = ++Num;
+      Frames.push_back(Frame(V, P, Num));
+    }
+
+    /// The algorithm of Bourdoncle with an explicit stack of calls
+    /// since the CFG of a huge function can be very deep. The value
+    /// returned by visit goes to the Head of its caller.
+    void build(BasicBlock *Entry, Partition &P){
+      std::vector<Frame> Frames;
+      pushVisit(Frames, Entry, &P);
+      while (!Frames.empty()){
+	Frame &Fr = Frames.back();
+	TerminatorInst *T = Fr.V->getTerminator();
+	if (Fr.Succ < T->getNumSuccessors()){
+	  BasicBlock *S = T->getSuccessor(Fr.Succ++);
+	  unsigned Min = getDFN(S);
+	  if (Fr.Body){
+	    // component
+	    if (Min == 0)
+	      pushVisit(Frames, S, Fr.Body);
+	  }
+	  else if (Min == 0)
+	    pushVisit(Frames, S, Fr.P);
+	  else if (Min <= Fr.Head){
+	    Fr.Head = Min;
+	    Fr.Loop = true;
+	  }
+	  continue;
+	}
+
+	if (!Fr.Body && Fr.Head == getDFN(Fr.V)){
+	  // End of visit and V is the head of a component or a single node.
+	  DFN[Fr.V] = ~0U;
+	  BasicBlock *Elem = Stack.back();
+	  Stack.pop_back();
+	  if (Fr.Loop){
+	    while (Elem != Fr.V){
+	      DFN[Elem] = 0;
+	      Elem = Stack.back();
+	      Stack.pop_back();
+	    }
+	    Fr.Body = new Partition();
+	    Fr.Succ = 0;
+	    continue;
+	  }
+	  Fr.P->push_back(std::vector<Node>(1, Node(Fr.V, false)));
+	}
+	else if (Fr.Body){
+	  // End of component.
+	  std::vector<Node> C(1, Node(Fr.V, true));
+	  flatten(*Fr.Body, C);
+	  C[0].Size = C.size();
+	  Fr.P->push_back(C);
+	  delete Fr.Body;
+	}
+
+	// Return Head to the caller. A component ignores it.
+	unsigned Head = Fr.Head;
+	Frames.pop_back();
+	if (!Frames.empty() && !Frames.back().Body && Head <= Frames.back().Head){
+	  Frames.back().Head = Head;
+	  Frames.back().Loop = true;
+	}
+      }
+    }
+
+    static void flatten(const Partition &P, std::vector<Node> &Out){
+      for (Partition::const_reverse_iterator I = P.rbegin(), E = P.rend();
+	   I != E; ++I)
+	Out.insert(Out.end(), I->begin(), I->end());
+    }
+  };
+
+} // end namespace
+
+#endif /*__WTO_H__*/
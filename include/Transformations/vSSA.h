@@ -5,6 +5,7 @@
 #include "llvm/Support/CFG.h"
 #include "llvm/Instructions.h"
 #include "llvm/Analysis/DominanceFrontier.h"
+#include "Support/DomIntervals.h"
 #include <deque>
 #include <algorithm>
 
@@ -20,6 +21,7 @@ public:
 private:
 	// Variables always live
 	DominatorTree *DT_;
+	unimelb::DominatorIntervals DI_;
 	DominanceFrontier *DF_;
 	void createSigmasIfNeeded(BasicBlock *BB);
 	void insertSigmas(TerminatorInst *TI, Value *V);
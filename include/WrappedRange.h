@@ -106,6 +106,14 @@ namespace unimelb {
       CounterWideningCannotDoubling = other.CounterWideningCannotDoubling;
     }
 
+    /// Overwrite this with V without allocating memory.
+    virtual void assign(AbstractValue *V){
+      BaseRange::assign(V);
+      WrappedRange *Other = cast<WrappedRange>(V);
+      __isBottom = Other->__isBottom;
+      CounterWideningCannotDoubling = Other->CounterWideningCannotDoubling;
+    }
+
     /// Destructor of the class.
     ~WrappedRange(){}
 
@@ -194,6 +202,9 @@ namespace unimelb {
     WrappedRange* clone(){
       return new WrappedRange(*this);
     }
+    WrappedRange* clone(BumpPtrAllocator &Arena){
+      return new (Arena.Allocate<WrappedRange>()) WrappedRange(*this);
+    }
 
     /// Methods for support type inquiry through isa, cast, and
     /// dyn_cast.
@@ -212,6 +223,8 @@ namespace unimelb {
     virtual void makeBot();
     virtual void makeTop();
     virtual void print(raw_ostream &Out) const;
+    virtual void write(raw_ostream &Out) const;
+    virtual bool read(StringRef &Str);
 
     inline void WrappedRangeAssign(WrappedRange * other) {
       BaseRange::RangeAssign(other);
@@ -237,7 +250,7 @@ namespace unimelb {
     virtual void GeneralizedJoin(std::vector<AbstractValue *>);
     virtual void meet(AbstractValue *, AbstractValue *);
     virtual bool isEqual(AbstractValue*);
-    virtual void widening(AbstractValue *, const std::vector<int64_t> &);
+    virtual void widening(AbstractValue *, const LandmarkSet &);
 
     /// Return true is this is syntactically identical to V.
     virtual bool isIdentical(AbstractValue *V);
@@ -267,10 +280,10 @@ namespace unimelb {
 		    const WrappedRange *,const WrappedRange *, bool);    
 
     // addition, substraction, and the rest above
-    virtual AbstractValue* visitArithBinaryOp(AbstractValue *, AbstractValue *,
-					      unsigned, const char *);
+    virtual void visitArithBinaryOp(AbstractValue *, AbstractValue *,
+				    unsigned, const char *);
     // truncation, signed/unsigned extension
-    virtual AbstractValue* visitCast(Instruction &, AbstractValue *, TBool *, bool);
+    virtual void visitCast(Instruction &, AbstractValue *, TBool *, bool);
     // and, or, xor 
     void WrappedLogicalBitwise(WrappedRange *, 
 			       WrappedRange *, WrappedRange *,
@@ -280,11 +293,19 @@ namespace unimelb {
 			       unsigned);
     // all bitwise operations: many of them are quite tricky because
     // they are not monotone
-    virtual AbstractValue*  visitBitwiseBinaryOp(AbstractValue *, AbstractValue *, 
-						 const Type *, const Type *,
-						 unsigned, const char *);
+    virtual void visitBitwiseBinaryOp(AbstractValue *, AbstractValue *, 
+				      const Type *, const Type *,
+				      unsigned, const char *);
+
+    /// Let the next threads reuse the caches of the transfer functions
+    /// of the threads that finished. Only the calling thread may be
+    /// running.
+    static void recycleTransferCaches();
 
   private: 
+    /// Memoization of the transfer functions (see WrappedRange.cpp).
+    friend class TransferCache;
+
     bool __isBottom; //!< If true the interval is bottom.
 
     // During widening it is possible that we cannot doubling the
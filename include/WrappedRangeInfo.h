@@ -0,0 +1,108 @@
+// Authors: Jorge. A Navas, Peter Schachte, Harald Sondergaard, and
+//          Peter J. Stuckey.
+// The University of Melbourne 2012.
+#ifndef __WRAPPED_RANGE_INFO_H__
+#define __WRAPPED_RANGE_INFO_H__
+///////////////////////////////////////////////////////////////////////////////
+/// \file WrappedRangeInfo.h
+///       Wrapped intervals for other passes.
+///
+/// The pass does nothing when it runs. A function is analyzed the
+/// first time one of its values, blocks or edges is queried and its
+/// results are kept until the pass is released, so a client pays
+/// only for the functions it touches. A client that changes a
+/// function after querying it must call forget.
+///
+/// The results are those of -wrapped-range-analysis on the current
+/// IR with the same options (-widening, -narrowing, -wto, ...). They
+/// are more precise if -range-transformations ran before. Without
+/// results (e.g., a declaration) every block and edge is considered
+/// feasible and no value has a range.
+///
+/// Usage from another pass:
+///
+/// \verbatim
+///   AU.addRequired<WrappedRangeInfo>();
+///   ...
+///   WrappedRangeInfo &WRI = getAnalysis<WrappedRangeInfo>();
+///   if (const WrappedRange *R = WRI.getRange(V)) ...
+/// \endverbatim
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FixpointSSI.h"
+#include "WrappedRange.h"
+#include "llvm/Pass.h"
+#include "llvm/Module.h"
+#include "llvm/Function.h"
+#include "llvm/BasicBlock.h"
+#include "llvm/Value.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <utility>
+
+using namespace llvm;
+
+namespace unimelb {
+
+  class WrappedRangeInfo : public ModulePass {
+  public:
+    static char ID; //!< Pass identification, replacement for typeid
+    /// Constructor of the class.
+    WrappedRangeInfo(): ModulePass(ID), M(NULL), AA(NULL), Analysis(NULL){}
+    /// Destructor of the class.
+    ~WrappedRangeInfo(){ releaseMemory(); }
+
+    virtual bool runOnModule(Module &M);
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+    virtual void releaseMemory();
+    /// Print the results of every function (e.g., with opt -analyze).
+    virtual void print(raw_ostream &Out, const Module *M) const;
+
+    /// Return the wrapped interval of V, which must be an argument or
+    /// an instruction, or NULL if it is not known. It remains valid
+    /// until its function is forgotten.
+    const WrappedRange* getRange(Value *V);
+    /// Return false if B is unreachable.
+    bool isReachable(BasicBlock *B);
+    /// Return false if the edge from From to its successor To is
+    /// never taken.
+    bool isEdgeFeasible(BasicBlock *From, BasicBlock *To);
+    /// Drop the results of F. They are computed again on the next
+    /// query.
+    void forget(Function *F);
+
+  private:
+    typedef std::pair<BasicBlock*,BasicBlock*> EdgeTy;
+    /// Results of an analyzed function.
+    struct FunctionInfo {
+      FunctionInfo(): Analyzed(false){}
+      ~FunctionInfo(){
+	for (DenseMap<Value*,WrappedRange*>::iterator
+	       I = Ranges.begin(), E = Ranges.end(); I != E; ++I)
+	  delete I->second;
+      }
+      /// False if the function could not be analyzed.
+      bool Analyzed;
+      /// Copies of the final abstract values (the fixpoint frees its
+      /// own on the next init).
+      DenseMap<Value*,WrappedRange*> Ranges;
+      SmallPtrSet<BasicBlock*,32> Reachable;
+      DenseSet<EdgeTy> FeasibleEdges;
+    };
+
+    Module *M;
+    AliasAnalysis *AA;
+    /// Analysis shared by all functions. Created on the first query.
+    FixpointSSI *Analysis;
+    DenseMap<Function*,FunctionInfo*> Infos;
+
+    /// Return the results of F, analyzing it if needed.
+    FunctionInfo* getInfo(Function *F);
+  };
+
+} // end namespace
+
+#endif /*__WRAPPED_RANGE_INFO_H__*/
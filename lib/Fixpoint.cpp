@@ -894,13 +894,12 @@ void Fixpoint::visitInst(Instruction &I) {
 	  // ValMap. If not, just top.
 	  AbstractValue * Op1 = Lookup(ValMap, I.getOperand(0), false);
 	  AbstractValue * Op2 = Lookup(ValMap, I.getOperand(1), false);
+	  NewV=OldV->clone();
 	  if (Op1 && Op2)
-	    NewV = OldV->visitArithBinaryOp(Op1,Op2,
-					    I.getOpcode(),I.getOpcodeName());
-	  else{
-	    NewV=OldV->clone();
+	    NewV->visitArithBinaryOp(Op1,Op2,
+				     I.getOpcode(),I.getOpcodeName());
+	  else
 	    NewV->makeTop();	      
-	  }
 	}
 	break;
       case Instruction::Shl:	// logical left shift
@@ -910,11 +909,12 @@ void Fixpoint::visitInst(Instruction &I) {
       case Instruction::Or:     // bitwise or
       case Instruction::Xor:    // bitwise xor
 	DEBUG(dbgs() << "Bitwise instruction: " << I << "\n");
-	NewV =  OldV->visitBitwiseBinaryOp(Lookup(ValMap, I.getOperand(0), true), 
-					   Lookup(ValMap, I.getOperand(1), true),
-					   I.getOperand(0)->getType(), 
-					   I.getOperand(1)->getType(),
-					   I.getOpcode() , I.getOpcodeName());
+	NewV = OldV->clone();
+	NewV->visitBitwiseBinaryOp(Lookup(ValMap, I.getOperand(0), true), 
+				   Lookup(ValMap, I.getOperand(1), true),
+				   I.getOperand(0)->getType(), 
+				   I.getOperand(1)->getType(),
+				   I.getOpcode() , I.getOpcodeName());
 	break;
       case Instruction::BitCast: // no-op cast from one type to another
       case Instruction::ZExt:    // zero extend integers
@@ -934,7 +934,8 @@ void Fixpoint::visitInst(Instruction &I) {
 	    SrcAbsV = Lookup(ValMap, I.getOperand(0), true);
 	  // At this point only either SrcAbsV or SrcFlag can be NULL
 	  assert(SrcFlag || SrcAbsV);
-	  NewV =  OldV->visitCast(I, SrcAbsV, SrcFlag, IsAllSigned);
+	  NewV = OldV->clone();
+	  NewV->visitCast(I, SrcAbsV, SrcFlag, IsAllSigned);
 	}
 	break;
       default: 
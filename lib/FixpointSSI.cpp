@@ -46,6 +46,10 @@
 /////////////////////////////////////////////////////////////////////////////////
 #include "FixpointSSI.h"
 #include "AbstractValue.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 using namespace llvm;
 using namespace unimelb;
@@ -58,21 +62,40 @@ STATISTIC(NumOfWideningPts   ,"Number of widening locations");
 STATISTIC(NumOfWidenings     ,"Number of widen instructions");
 STATISTIC(NumOfNarrowings    ,"Number of narrowing passes");
 STATISTIC(NumOfSkippedIns    ,"Number of skipped instructions");
+STATISTIC(NumOfComponentIter ,"Number of iterations over WTO components");
+STATISTIC(NumOfWarmStarts    ,"Number of functions started from a snapshot");
+STATISTIC(NumOfWarmSeeds     ,"Number of changed instructions after a warm start");
+STATISTIC(NumOfDegradedFuncs ,"Number of functions that ran out of budget");
+STATISTIC(NumOfBudgetTops    ,"Number of values sent to top by a budget");
+STATISTIC(NumOfSharedConsts  ,"Number of constant values shared between slots");
+STATISTIC(NumOfSharedTops    ,"Number of top values shared between slots");
 
 // Debugging
 void printValueInfo(Value *,Function*);
-void printUsersInst(Value *,SmallPtrSet<BasicBlock*, 16>,bool);
 inline void PRINTCALLER(std::string s){ /*dbgs() << s << "\n";*/ }
 
 FixpointSSI::
 FixpointSSI(Module *M,  unsigned WL, unsigned NL, AliasAnalysis *AA,
 	    OrderingTy ord):
   M(M),
+  NumOfInstSlots(0),
   WideningLimit(WL),
   ConstSetOrder(ord),
   NarrowingLimit(NL),
   NarrowingPass(false),
+  SparseNarrowing(false),
+  Strategy(CHAOTIC),
+  WTO(NULL),
   AA(AA),
+  WarmStarted(false),
+  VisitBudget(0),
+  TimeBudget(0),
+  WideningBudget(0),
+  NumOfVisits(0),
+  ExhaustedBudget(NULL),
+  ForceTop(false),
+  Summaries(NULL),
+  Store(NULL),
   IsAllSigned(true){
   if (WideningLimit == 0)
     dbgs() << "Warning: user selected no widening!\n";
@@ -86,11 +109,24 @@ FixpointSSI(Module *M, unsigned WL, unsigned NL,
 	    AliasAnalysis *AA, bool isSigned,
 	    OrderingTy ord):
   M(M),
+  NumOfInstSlots(0),
   WideningLimit(WL),
   ConstSetOrder(ord),
   NarrowingLimit(NL),
   NarrowingPass(false),
+  SparseNarrowing(false),
+  Strategy(CHAOTIC),
+  WTO(NULL),
   AA(AA),
+  WarmStarted(false),
+  VisitBudget(0),
+  TimeBudget(0),
+  WideningBudget(0),
+  NumOfVisits(0),
+  ExhaustedBudget(NULL),
+  ForceTop(false),
+  Summaries(NULL),
+  Store(NULL),
   IsAllSigned(isSigned){
   if (WideningLimit == 0)
     dbgs() << "Warning: user selected no widening!\n";
@@ -99,102 +135,342 @@ FixpointSSI(Module *M, unsigned WL, unsigned NL,
   }
 
 FixpointSSI::~FixpointSSI(){
-  for (AbstractStateTy::iterator 
-	 I = ValueState.begin(), 
-	 E=ValueState.end(); I!=E; ++I)
+  Cleanup();
+  for (DenseMap<ConstantInt*,AbstractValue*>::iterator 
+	 I = InternedConstants.begin(), E = InternedConstants.end(); I != E; ++I)
     delete I->second;
-  for (DenseMap<Value*,TBool*>::iterator 
-	 I=TrackedCondFlags.begin(), 
-	 E=TrackedCondFlags.end(); I!=E; ++I)
+  for (DenseMap<unsigned,AbstractValue*>::iterator 
+	 I = InternedTops.begin(), E = InternedTops.end(); I != E; ++I)
     delete I->second;
+}
+
+const unsigned FixpointSSI::NoSlot;
+Mutex FixpointSSI::IRLock;
+
+/// Return the shared abstract value of the constant C.
+AbstractValue* FixpointSSI::internConstant(ConstantInt *C){
+  AbstractValue *&V = InternedConstants[C];
+  if (!V)
+    V = initAbsIntConstant(C);
+  else
+    NumOfSharedConsts++;
+  return V;
+}
+
+/// Return the shared top value of width Width. V is any value of that
+/// width.
+AbstractValue* FixpointSSI::internTop(Value *V, unsigned Width){
+  AbstractValue *&T = InternedTops[Width];
+  if (!T)
+    T = initAbsValTop(V);
+  else
+    NumOfSharedTops++;
+  return T;
+}
+
+/// Number the blocks, edges, instructions and arguments of F. Blocks
+/// are numbered following a reverse post-order of the CFG so that
+/// the worklists always pop first the element closest to the entry
+/// block. This visits definitions before their uses (except through
+/// backedges) and makes the iteration order independent of where
+/// values live in memory. Unreachable blocks go last.
+void FixpointSSI::addSlots(Function *F){
+  ReversePostOrderTraversal<Function*> RPOT(F);
+  for (ReversePostOrderTraversal<Function*>::rpo_iterator 
+	 I = RPOT.begin(), E = RPOT.end(); I != E; ++I){
+    BlockMap[*I] = Blocks.size();
+    Blocks.push_back(*I);
+  }
+  for (Function::iterator B = F->begin(), BE = F->end(); B != BE; ++B){
+    if (BlockMap.insert(std::make_pair(&*B, (unsigned) Blocks.size())).second)
+      Blocks.push_back(B);
+  }
+
+  // Instructions
+  for (unsigned b=0, nb=Blocks.size(); b < nb; b++){
+    BlockBegin.push_back(SlotValue.size());
+    for (BasicBlock::iterator I = Blocks[b]->begin(), E = Blocks[b]->end(); 
+	 I != E; ++I){
+      addSlot(&*I);
+      InstBlock.push_back(b);
+    }
+  }
+  BlockBegin.push_back(SlotValue.size());
+  NumOfInstSlots = SlotValue.size();
+
+  // Edges
+  unsigned NumOfEdges=0;
+  for (unsigned b=0, nb=Blocks.size(); b < nb; b++){
+    EdgeBegin.push_back(NumOfEdges);
+    TerminatorInst *TI = Blocks[b]->getTerminator();
+    for (unsigned i=0, e=TI->getNumSuccessors(); i < e; i++, NumOfEdges++)
+      EdgeDest.push_back(BlockMap[TI->getSuccessor(i)]);
+  }
+  EdgeBegin.push_back(NumOfEdges);
+
+  // Formal parameters
+  for (Function::arg_iterator 
+	 argIt=F->arg_begin(),E=F->arg_end(); argIt != E; argIt++) 
+    addSlot(&*argIt);
+
+  BBExecutable.resize(Blocks.size());
+  KnownFeasibleEdges.resize(NumOfEdges);
+  WideningPoints.resize(NumOfInstSlots);
+  NarrowingSeeds.resize(NumOfInstSlots);
+  InstWorkList.resize(NumOfInstSlots);
+  BBWorkList.resize(Blocks.size());
+}
+
+/// Return the edge from the block slot B to the block Dest.
+static unsigned getEdge(const std::vector<unsigned> &EdgeBegin, 
+			const std::vector<unsigned> &EdgeDest,
+			unsigned B, unsigned Dest){
+  for (unsigned e=EdgeBegin[B]; e < EdgeBegin[B+1]; e++){
+    if (EdgeDest[e] == Dest)
+      return e;
+  }
+  llvm_unreachable("getEdge: edge not found");
+  return FixpointSSI::NoSlot;
+}
+
+/// Record the slots of the operands of each instruction. It must be
+/// called once all the values of F have a slot.
+void FixpointSSI::addOperandSlots(Function *F){
+  for (unsigned i=0; i < NumOfInstSlots; i++){
+    OperandBegin.push_back(OperandSlots.size());
+    Instruction *I = cast<Instruction>(SlotValue[i]);
+    PHINode *PN = dyn_cast<PHINode>(I);
+    for (unsigned k=0, e=I->getNumOperands(); k < e; k++){
+      Value *Op = I->getOperand(k);
+      // PHI nodes ignore their undef operands.
+      if (PN && Op->getValueID() == Value::UndefValueVal)
+	OperandSlots.push_back(NoSlot);
+      else
+	OperandSlots.push_back(getSlot(Op));
+      if (PN)
+	OperandEdges.push_back(getEdge(EdgeBegin, EdgeDest, 
+				       getBlockSlot(PN->getIncomingBlock(k)),
+				       InstBlock[i]));
+      else
+	OperandEdges.push_back(NoSlot);
+    }
+  }
+  OperandBegin.push_back(OperandSlots.size());
+}
+
+// Reduce the number of cases. After swapping the operands, only six
+// cases: EQ, NEQ, SLE, ULE, ULT, and SLT. Swapped is true if the
+// operands must be swapped.
+//
+// Important: we never swap the operands of the instruction itself
+// since it may disable some def-use chains. This causes to reach too
+// early fixpoints (e.g., test-unbounded-loop-3.c).
+CmpInst::Predicate normalizeCmpPredicate(CmpInst::Predicate Pred, bool &Swapped){
+  switch (Pred){
+  case ICmpInst::ICMP_UGT:	
+  case ICmpInst::ICMP_SGT:	
+  case ICmpInst::ICMP_UGE:	
+  case ICmpInst::ICMP_SGE:	
+    Swapped = true;
+    return CmpInst::getSwappedPredicate(Pred);
+  default: 
+    Swapped = false;
+    return Pred;
+  }
+}
+
+/// Record for each comparison of F its normalized predicate and the
+/// slots of its operands so visitComparisonInst does not need to
+/// look at (or modify) the instruction. It must be called after
+/// addOperandSlots.
+void FixpointSSI::addCmpDescriptors(Function *F){
+  CmpDescs.resize(NumOfInstSlots);
+  for (unsigned Slot=0; Slot < NumOfInstSlots; Slot++){
+    ICmpInst *I = dyn_cast<ICmpInst>(SlotValue[Slot]);
+    if (!I) continue;
+    bool Swapped;
+    CmpDescriptor &D = CmpDescs[Slot];
+    D.Pred = normalizeCmpPredicate(I->getPredicate(), Swapped);
+    D.Op1  = getOperandSlot(Slot, Swapped ? 1 : 0);
+    D.Op2  = getOperandSlot(Slot, Swapped ? 0 : 1);
+  }
+}
 
-  ConstSet.clear();
+/// Generate the filters of all the sigma nodes of F. This must be
+/// done before addUserSlots since the filters add dependencies which
+/// do not appear in the def-use chains.
+void FixpointSSI::addSigmaFilters(Function *F){
+  for (unsigned Slot=0; Slot < NumOfInstSlots; Slot++){
+    PHINode *PN = dyn_cast<PHINode>(SlotValue[Slot]);
+    if (!PN || PN->getNumIncomingValues() != 1 || !AbsState[Slot]) 
+      continue;
+    if (BranchInst *BI = 
+	dyn_cast<BranchInst>(PN->getIncomingBlock(0)->getTerminator())){
+      if (BI->isConditional())
+	generateFilters(PN, PN->getIncomingValue(0), BI, PN->getParent());
+    }
+  }
+}
+
+/// Build the dependency graph of F in compressed sparse row format:
+/// the users of slot S are UserSlots[UserBegin[S]...UserBegin[S+1]-1]
+/// sorted by slot and without duplicates.
+///
+/// Apart from the def-use chains we need to pay special attention to
+/// sigma nodes. For code like this:
+/// \verbatim
+/// tmp4  = icmp slt i, j
+/// ....
+/// sigma =  phi [i,..]
+/// \endverbatim
+/// sigma is an user of i. However, sigma is also indirectly an user
+/// of j since its filter mentions j. That is, if j is modified we
+/// should re-analyze sigma. This dependency does not appear in the
+/// def-use information so we take it from TrackedValuesUsedSigmaNode.
+void FixpointSSI::addUserSlots(Function *F){
+  std::vector<std::pair<unsigned,unsigned> > Deps;
+  for (unsigned Slot=0; Slot < NumOfInstSlots; Slot++){
+    for (unsigned k=0, e=getNumOperands(Slot); k < e; k++){
+      unsigned Op = getOperandSlot(Slot,k);
+      if (Op != NoSlot && Op != Slot)
+	Deps.push_back(std::make_pair(Op,Slot));
+    }
+  }
+  for (SigmaUsersTy::iterator I = TrackedValuesUsedSigmaNode.begin(), 
+	 E = TrackedValuesUsedSigmaNode.end(); I != E; ++I){
+    unsigned Op = getSlot(I->first);
+    if (Op == NoSlot) continue;
+    for (SmallValueSet::iterator SI = I->second->begin(), 
+	   SE = I->second->end(); SI != SE; ++SI){
+      unsigned Sigma = getSlot(*SI);
+      if (Sigma != NoSlot && Sigma != Op)
+	Deps.push_back(std::make_pair(Op,Sigma));
+    }
+  }
+  std::sort(Deps.begin(), Deps.end());
+  Deps.erase(std::unique(Deps.begin(), Deps.end()), Deps.end());
+
+  unsigned NumOfSlots = SlotValue.size();
+  UserBegin.assign(NumOfSlots+1, 0);
+  UserSlots.reserve(Deps.size());
+  for (unsigned i=0, e=Deps.size(); i < e; i++){
+    UserBegin[Deps[i].first+1]++;
+    UserSlots.push_back(Deps[i].second);
+  }
+  for (unsigned i=0; i < NumOfSlots; i++)
+    UserBegin[i+1] += UserBegin[i];
 }
 
 void FixpointSSI::init(Function *F){
 
   Cleanup();
-  // Pessimistic assumption about trackable global variables. In this
-  // case, no bother running an expensive alias analysis.
-  // addTrackedGlobalVariablesPessimistically(M);
   unsigned Width;
   Type * Ty;
   if (Utilities::IsTrackableFunction(F)){
+    addSlots(F);
+    // Pessimistic assumption about trackable global variables. In this
+    // case, no bother running an expensive alias analysis.
+    // addTrackedGlobalVariablesPessimistically(M);
+
     // Add formal parameters as definitions and initialize the
-    // abstract value
+    // abstract value: top unless all the calls to F are known.
+    SummaryTable::Entry *Callers = Summaries ? Summaries->lookup(F) : NULL;
+    if (Callers && !Callers->ArgsKnown)
+      Callers = NULL;
     for (Function::arg_iterator 
 	   argIt=F->arg_begin(),E=F->arg_end(); argIt != E; argIt++) {
       DEBUG(printValueInfo(argIt,F));
+      unsigned Slot = getSlot(argIt);
       if (isCondFlag(argIt)){
 	DEBUG(dbgs() << "\trecording a Boolean flag:" 
 	      << argIt->getName() << "\n");
-	TrackedCondFlags.insert(std::make_pair(&*argIt, new TBool()));
+	TBool Init; // maybe
+	if (Callers){
+	  unsigned k = argIt->getArgNo();
+	  Init.makeBottom();
+	  for (unsigned i=0, e=Callers->CallSites.size(); i < e; i++)
+	    Init.join(Callers->CallSites[i]->Flags[k]);
+	}
+	Flags.add(Slot, Init);
       }
       else{
 	if (Utilities::getTypeAndWidth(argIt, Ty, Width)){
-	  AbstractValue *Top = initAbsValTop(argIt);
-	  Top->setBasicBlock(&F->getEntryBlock());
-	  ValueState.insert(std::make_pair(&*argIt,Top));      
+	  AbstractValue *Init = Callers ? 
+	    initArgFromCallSites(argIt, *Callers) : initAbsValTop(argIt, &Arena);
+	  Init->setBasicBlock(&F->getEntryBlock());
+	  AbsState[Slot] = Init;
 	}
       }
     } // end for
     
     // Add instructions as definitions and initialize the abstract value
-    for (inst_iterator I = inst_begin(F), E=inst_end(F) ; I != E; ++I){
-      DEBUG(printValueInfo(&*I,F));
+    for (unsigned Slot=0; Slot < NumOfInstSlots; Slot++){
+      Instruction *I = cast<Instruction>(SlotValue[Slot]);
+      DEBUG(printValueInfo(I,F));
       if (HasLeftHandSide(*I)){
-	if (Value * V = dyn_cast<Value>(&*I)){
-	  if (isCondFlag(V)){
-	    DEBUG(dbgs() << "\trecording a Boolean flag:" << V->getName() << "\n");
-	    TrackedCondFlags.insert(std::make_pair(&*V, new TBool()));
-	  }	
-	  else{
-	    if (Utilities::getTypeAndWidth(V, Ty, Width)){
-	      AbstractValue *Bot = initAbsValBot(V);
-	      Bot->setBasicBlock(I->getParent());
-	      ValueState.insert(std::make_pair(&*V,Bot));      	
-	    }
+	if (isCondFlag(I)){
+	  DEBUG(dbgs() << "\trecording a Boolean flag:" << I->getName() << "\n");
+	  Flags.add(Slot);
+	}	
+	else{
+	  if (Utilities::getTypeAndWidth(I, Ty, Width)){
+	    AbstractValue *Bot = initAbsValBot(I, &Arena);
+	    Bot->setBasicBlock(I->getParent());
+	    AbsState[Slot] = Bot;
 	  }
 	}
       }
     } // end for    
-    
-    /// Record all constant integers that appear in the program.
-    /// We put them into a set first to eliminate duplicates.
-    std::set<int64_t> Set;
-    Utilities::recordIntegerConstants(F,Set);
-    std::copy(Set.begin(), Set.end(), std::back_inserter(ConstSet));
-    // Sort them
-    if (ConstSetOrder == LESS_THAN){
-      // Since Set is ordered already using signed < we don't need to
-      // do anything here.
-      // std::sort(ConstSet.begin(), ConstSet.end()); 
-    }
-    else if (ConstSetOrder == LEX_LESS_THAN)
-      std::sort(ConstSet.begin(), ConstSet.end(), Utilities::Lex_LessThan_Comp);
-    else 
-      llvm_unreachable("Unsupported ordering");
-    DEBUG(Utilities::printIntConstants(ConstSet));
 
     /// Create an abstract value for each integer constant in the
     /// program.
     std::vector<std::pair<Value*,ConstantInt*> > NewAbsVals;
-    Utilities::addTrackedIntegerConstants(F, IsAllSigned, NewAbsVals); 
+    {
+      // It may create new constants in the LLVMContext.
+      ScopedLock Lock(IRLock);
+      Utilities::addTrackedIntegerConstants(F, IsAllSigned, NewAbsVals); 
+    }
     for (unsigned int i=0; i<NewAbsVals.size(); i++){
-      ValueState.insert(std::make_pair(NewAbsVals[i].first,
-				       initAbsIntConstant(NewAbsVals[i].second)));   
+      unsigned Slot = addSlot(NewAbsVals[i].first);
+      if (!AbsState[Slot])
+	AbsState[Slot] = internConstant(NewAbsVals[i].second);
+    }
+    // The other integer constants (e.g., undef or constant
+    // expressions) are top so they share the top of their width
+    // rather than making top the instructions that use them.
+    for (unsigned Slot=0; Slot < NumOfInstSlots; Slot++){
+      Instruction *I = cast<Instruction>(SlotValue[Slot]);
+      for (unsigned k=0, e=I->getNumOperands(); k < e; k++){
+	Value *Op = I->getOperand(k);
+	if (!isa<Constant>(Op) || isa<GlobalValue>(Op) || getSlot(Op) != NoSlot)
+	  continue;
+	if (Utilities::getTypeAndWidth(Op, Ty, Width))
+	  AbsState[addSlot(Op)] = internTop(Op, Width);
+      }
+    }
+    addOperandSlots(F);
+    addCmpDescriptors(F);
+    addSigmaFilters(F);
+    addUserSlots(F);
+
+    if (Strategy == WTO_RECURSIVE){
+      WTO = new WeakTopologicalOrder(F);
+      DEBUG(dbgs() << "WTO: "; WTO->print(dbgs()));
+      NumOfBlockChanges.resize(Blocks.size(), 0);
     }
     // Record widening points.
     addTrackedWideningPoints(F);      
+    // Reuse the state of the previous run if possible.
+    if (!WarmStartDir.empty())
+      WarmStarted = loadSnapshot(F);
 
 #ifdef SKIP_TRAP_BLOCKS
-    for (Function::iterator B = F->begin(), BE = F->end(); B != BE; ++B){
-      for (BasicBlock::iterator I = B->begin(), IE = B->end(); I != IE; ++I){
-	if (CallInst *CI = dyn_cast<CallInst>(&*I)){
-	  if (Function *F = CI->getCalledFunction()){
-	    if (F->getName().endswith("trap_handler"))
-	      TrackedTrapBlocks.insert(std::make_pair(B,0));
-	  }
+    TrackedTrapBlocks.resize(Blocks.size());
+    for (unsigned Slot=0; Slot < NumOfInstSlots; Slot++){
+      if (CallInst *CI = dyn_cast<CallInst>(SlotValue[Slot])){
+	if (Function *F = CI->getCalledFunction()){
+	  if (F->getName().endswith("trap_handler"))
+	    TrackedTrapBlocks.set(InstBlock[Slot]);
 	}
       }
     }
@@ -205,8 +481,24 @@ void FixpointSSI::init(Function *F){
 
 // Iterative intraprocedural fixpoint + narrowing.
 void FixpointSSI::solve(Function *F){
+  NumOfVisits = 0;
+  if (TimeBudget)
+    StartTime = sys::TimeValue::now();
+  if (WideningBudget)
+    NumOfWideningsAt.assign(NumOfInstSlots, 0);
   solveLocal(F);
-  computeNarrowing(F);
+  if (!ForceTop)
+    computeNarrowing(F);
+  if (ExhaustedBudget){
+    NumOfDegradedFuncs++;
+    dbgs() << "Warning: analysis of " << F->getName() << " ran out of its " 
+	   << ExhaustedBudget << " budget\n";
+  }
+  // A degraded result would be reused forever by the next runs.
+  else if (!WarmStartDir.empty())
+    saveSnapshot(F);
+  if (Store)
+    storeResults(F);
 }
 
 // Compute a intraprocedural fixpoint until no change applying the
@@ -221,8 +513,41 @@ void FixpointSSI::solveLocal(Function *F){
   // first time all blocks are kept as processed so nothing will be
   // done. 
   //cleanupPreviousFunctionAnalysis(F);
-  markBlockExecutable(&F->getEntryBlock());    
-  computeFixpo();
+  if (WarmStarted){
+    // The executable blocks and edges and the values come from the
+    // previous run. They are still a solution except for the
+    // instructions that changed so we start from them and their
+    // users. The WTO strategy would visit all blocks so the changes
+    // are propagated with the worklists also in that case. The heads
+    // of the components are still the widening points so every cycle
+    // is widened.
+    NumOfWarmStarts++;
+    NumOfWarmSeeds += WarmSeeds.size();
+    IterationStrategyTy OldStrategy = Strategy;
+    Strategy = CHAOTIC;
+    for (unsigned i=0, e=WarmSeeds.size(); i < e; i++){
+      unsigned S = WarmSeeds[i];
+      if (!isExecutableInst(S)) continue;
+      visitInst(S);
+      for (unsigned u = UserBegin[S], ue = UserBegin[S+1]; u != ue; ++u){
+	if (isExecutableInst(UserSlots[u]))
+	  visitInst(UserSlots[u]);
+      }
+    }
+    computeFixpo();
+    Strategy = OldStrategy;
+    DEBUG(dbgs () << "Fixpoint reached for " << F->getName() << ".\n");
+    return;
+  }
+  // The entry block is always the first block slot.
+  markBlockExecutable(0);    
+  if (Strategy == WTO_RECURSIVE){
+    // The WTO decides the order in which blocks are visited.
+    BBWorkList.clear();
+    computeFixpoWTO(0, WTO->size());
+  }
+  else
+    computeFixpo();
   DEBUG(dbgs () << "Fixpoint reached for " << F->getName() << ".\n");
 }
 
@@ -231,99 +556,105 @@ void FixpointSSI::computeFixpo(){
   while (!BBWorkList.empty() || !InstWorkList.empty()) {
     // Process the instruction work list.
     while (!InstWorkList.empty()) {
-      std::set<Value*>::iterator It = InstWorkList.begin();
-      InstWorkList.erase(It);
-      Value *I = *It;
+      unsigned Slot = InstWorkList.pop();
+      Value *I = SlotValue[Slot];
       // "I" got into the work list because it made a transition.  See
       // if any users are both live and in need of updating.
       DEBUG(dbgs() << "\n*** Popped off I-WL: " << *I << "\n");      
-      DEBUG(printUsersInst(I,BBExecutable,true));
-      for (Value::use_iterator UI = I->use_begin(), E = I->use_end();
-           UI != E; ++UI) {
-        Instruction *U = cast<Instruction>(*UI);
+      for (unsigned u = UserBegin[Slot], ue = UserBegin[Slot+1]; u != ue; ++u){
+        unsigned U = UserSlots[u];
 	// We check that the instruction U is defined in an executable
 	// block
-        if (BBExecutable.count(U->getParent()) && U != I) {
-	  DEBUG(dbgs() << "\n***Visiting: " << *U << " as user of " 
+        if (isExecutableInst(U)) {
+	  DEBUG(dbgs() << "\n***Visiting: " << *SlotValue[U] << " as user of " 
 		<< *I << "\n");      
-          visitInst(*U);
+          visitInst(U);
 	}
       } // end for
-
-      /// We need to pay special attention to sigma nodes for two
-      /// reasons. For code like this:
-      /// \verbatim
-      /// i = phi [tmp6,...] [0,...]
-      /// ...
-      /// sigma  = phi [i,...]
-      /// tmp6 = add sigma, 1
-      /// \endverbatim
-      /// Assume that tmp6 changes from [0,0] to [1,1]. As a result,
-      /// we push tmp6 into IWorklist. Then, we analyze i and infer
-      /// than i=[0,1], and push i also in the IWorklist. If we pop
-      /// first tmp6 from IWorklist then tmp6 is again [1,1] since
-      /// sigma was not updated. This suggests that we should visit
-      /// first sigma nodes.  Another issue arises with code like this:
-      /// \verbatim
-      /// tmp4  = icmp slt i, j
-      /// ....
-      /// sigma =  phi [i,..]
-      /// \endverbatim
-      /// Here sigma is an user of i. However, sigma is also indirectly
-      /// an user of j. That is, if j is modified we should re-analyze
-      /// sigma. However, this dependency between j and sigma does not
-      /// appear in the def-use information.  We solve in a bit clumsy
-      /// way these two issues by tracking a map from V to set(V) that
-      /// keeps track of for a given variable V which is the set of
-      /// sigma nodes that should be re-analyzed.
-      ///
-      /// \bug: we are visiting twice the number of sigma nodes.
-      if (SmallValueSet * SigmaSet = TrackedValuesUsedSigmaNode[I]){
-	for( SmallValueSet::iterator UI = SigmaSet->begin(),
-	       UE = SigmaSet->end(); UI != UE; ++UI){
-	  Instruction * U = cast<Instruction>(*UI);
-	  if (BBExecutable.count(U->getParent())) {
-	    DEBUG(dbgs() << "\n***Forcing the visit of: " << *U 
-		  << " as user of " << *I << "\n");      
-	    visitInst(*U);
-	  }
-	} // end inner for
-      }      
     } // end while
 
     // Process the basic block work list.
     while (!BBWorkList.empty()) {
-      std::set<BasicBlock*>::iterator BBIt = BBWorkList.begin();
-      BBWorkList.erase(BBIt);
-      BasicBlock *BB = *BBIt;
-      DEBUG(dbgs() << "\n***Popped off BBWL: " << *BB);
+      unsigned BB = BBWorkList.pop();
+      DEBUG(dbgs() << "\n***Popped off BBWL: " << *Blocks[BB]);
       // Notify all instructions in this basic block that they are newly
       // executable.
-      for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I){
-        visitInst(*I);
-      }
+      for (unsigned I = BlockBegin[BB], E = BlockBegin[BB+1]; I != E; ++I)
+        visitInst(I);
     } // end while
   } // end outer while
 }
 
+/// Visit all the instructions of the block B if it is executable.
+void FixpointSSI::visitBlock(unsigned B){
+  if (!BBExecutable.test(B)) return;
+#ifdef SKIP_TRAP_BLOCKS
+  if (TrackedTrapBlocks.test(B)) return;
+#endif 
+  DEBUG(dbgs() << "\n***Visiting block: " << Blocks[B]->getName() << "\n");
+  for (unsigned I = BlockBegin[B], E = BlockBegin[B+1]; I != E; ++I)
+    visitInst(I);
+}
+
+/// Recursive iteration strategy of Bourdoncle: visit the nodes of the
+/// WTO in the range [Begin,End) stabilizing each component before
+/// moving to the next node.
+void FixpointSSI::computeFixpoWTO(unsigned Begin, unsigned End){
+  unsigned i = Begin;
+  while (i < End){
+    const WeakTopologicalOrder::Node &N = (*WTO)[i];
+    if (N.IsHead)
+      stabilizeComponent(i);
+    else
+      visitBlock(getBlockSlot(N.BB));
+    i += N.Size;
+  }
+}
+
+/// Iterate the component whose head is the i-th node of the WTO
+/// until its head is stable. Since every cycle of the component goes
+/// through the head, if the head did not change since the last time
+/// the body was visited then the whole component is stable. Note that
+/// the values of the head can also change while visiting the body
+/// (e.g., if a backedge becomes feasible) so we compare against the
+/// number of changes seen before visiting the body.
+void FixpointSSI::stabilizeComponent(unsigned i){
+  const WeakTopologicalOrder::Node &Head = (*WTO)[i];
+  unsigned HeadSlot = getBlockSlot(Head.BB);
+  bool FirstIter = true;
+  unsigned BeforeBody = 0;
+  ActiveComponents.push_back(i);
+  while (true){
+    NumOfComponentIter++;
+    visitBlock(HeadSlot);
+    unsigned Changes = NumOfBlockChanges[HeadSlot];
+    if (!FirstIter && Changes == BeforeBody)
+      break;
+    if (!BBExecutable.test(HeadSlot))
+      break;
+    FirstIter = false;
+    BeforeBody = Changes;
+    computeFixpoWTO(i+1, i+Head.Size);
+  }
+  ActiveComponents.pop_back();
+}
+
 /// Iterate over all instructions in the function and apply the
 /// corresponding transfer function for every one without
 /// widening. The instructions must be visited preserving the original
 /// order in the program.
 /// \lambda x. x /\ F(x)
 void FixpointSSI::computeOneNarrowingIter(Function *F){
-  markBlockExecutable(&F->getEntryBlock());    
+  markBlockExecutable(0);    
   // Iterator dfs over the basic blocks in the function
   for (df_iterator<BasicBlock*>  DFI = df_begin(&F->getEntryBlock()), 
  	                         DFE = df_end(&F->getEntryBlock()); 
        DFI != DFE; ++DFI) {  
 
-    BasicBlock * BB = *DFI;
-    if (BBExecutable.count(BB)){
-      for (BasicBlock::iterator I = BB->begin(), E = BB->end(); 
-	   I != E; ++I){
-	  visitInst(*I);
-      }
+    unsigned BB = getBlockSlot(*DFI);
+    if (BBExecutable.test(BB)){
+      for (unsigned I = BlockBegin[BB], E = BlockBegin[BB+1]; I != E; ++I)
+	visitInst(I);
     }
   }
 }
@@ -334,6 +665,9 @@ void FixpointSSI::computeNarrowing(Function *EntryF){
 
   if (NarrowingLimit == 0) return;
 
+  if (SparseNarrowing)
+    return computeSparseNarrowing(EntryF);
+
   unsigned N = NarrowingLimit;
   NarrowingPass=true;
 
@@ -354,11 +688,45 @@ void FixpointSSI::computeNarrowing(Function *EntryF){
   DEBUG(dbgs () << "Narrowing finished.\n");
 }
 
-bool FixpointSSI::
-isEdgeFeasible(BasicBlock *From, BasicBlock *To){
-  std::set<Edge>::iterator 
-    I =  KnownFeasibleEdges.find(std::make_pair(From,To));  
-  if (I != KnownFeasibleEdges.end()) 
+/// Sparse version of computeNarrowing. Each round re-evaluates the
+/// seeds (see NarrowingSeeds) and propagates through the dependency
+/// graph only the values that strictly decrease. Widening points
+/// reached during the propagation are postponed to the next round so
+/// that a round cannot go around a loop. We stop as soon as a round
+/// does not change anything or after NarrowingLimit rounds.
+void FixpointSSI::computeSparseNarrowing(Function *F){
+  NarrowingPass=true;
+  BitVector Seeds(NarrowingSeeds);
+  unsigned N = NarrowingLimit;
+  while (N-- > 0 && Seeds.any()){
+    DEBUG(dbgs () << "\nStarting sparse narrowing  ... \n");
+    NumOfNarrowings++;    
+    assert(InstWorkList.empty() && "The worklist should be empty");
+    for (int S = Seeds.find_first(); S != -1; S = Seeds.find_next(S)){
+      if (isExecutableInst(S))
+	visitInst(S);
+    }
+    Seeds.reset();
+    // Here InstWorkList contains the instructions whose value
+    // decreased.
+    while (!InstWorkList.empty()){
+      unsigned Slot = InstWorkList.pop();
+      for (unsigned u = UserBegin[Slot], ue = UserBegin[Slot+1]; u != ue; ++u){
+        unsigned U = UserSlots[u];
+	if (!isExecutableInst(U)) continue;
+	if (WideningPoints.test(U))
+	  Seeds.set(U);
+	else
+	  visitInst(U);
+      }
+    }
+  }
+  NarrowingPass=false;
+  DEBUG(dbgs () << "Narrowing finished.\n");
+}
+
+bool FixpointSSI::isEdgeFeasible(unsigned Edge){
+  if (KnownFeasibleEdges.test(Edge)) 
     return true;
   else{   
     NumOfInfeasible++;		  
@@ -371,11 +739,16 @@ isEdgeFeasible(BasicBlock *From, BasicBlock *To){
 // worklist and apply widening if widening conditions are
 // applicable. If we are doing a narrowing pass then widening is
 // disabled and we don't add anything in the worklist.
-void FixpointSSI::updateState(Instruction &Inst, AbstractValue * NewV) {
+//
+// NewV must be the scratch value of the slot (see getScratch). If
+// the new value is kept then it is swapped with the old one which
+// becomes the scratch value. Thus, no memory is allocated or freed
+// here.
+void FixpointSSI::updateState(unsigned Slot, AbstractValue * NewV) {
 
   assert(NewV != NULL && "updateState: instruction not defined"); 
-  AbstractStateTy::iterator I = ValueState.find(&Inst);
-  AbstractValue* OldV  = I->second;
+  assert(NewV == Scratch[Slot] && "updateState: expected the scratch value");
+  AbstractValue* OldV  = AbsState[Slot];
 
   // DEBUG(dbgs() << "Old value: " );
   // DEBUG(OldV->print(dbgs()));
@@ -384,15 +757,28 @@ void FixpointSSI::updateState(Instruction &Inst, AbstractValue * NewV) {
   // DEBUG(NewV->print(dbgs()));
   // DEBUG(dbgs() << "\n" );
 
-  if (NarrowingPass){
+  if (NarrowingPass && SparseNarrowing){
+    // Keep only values that strictly decrease.
+    if (!NewV->lessOrEqual(OldV) || OldV->lessOrEqual(NewV))
+      return;
+    DEBUG(dbgs() << "***[Narrowing] from ");
+    DEBUG(OldV->print(dbgs()));
+    DEBUG(dbgs() << " to " );
+    DEBUG(NewV->print(dbgs()));
+    DEBUG(dbgs() << "\n" );
+    Scratch[Slot]  = OldV;
+    AbsState[Slot] = NewV;
+    InstWorkList.insert(Slot);
+  }
+  else if (NarrowingPass){
     DEBUG(dbgs() << "***[Narrowing] from ");
     DEBUG(OldV->print(dbgs()));
     DEBUG(dbgs() << " to " );
     DEBUG(NewV->print(dbgs()));
     DEBUG(dbgs() << "\n" );
     assert(NewV);
-    delete ValueState[&Inst];
-    ValueState[&Inst] = NewV;
+    Scratch[Slot]  = OldV;
+    AbsState[Slot] = NewV;
   }
   else{
     ////////////////////////////////////////////////////////////////////
@@ -404,20 +790,34 @@ void FixpointSSI::updateState(Instruction &Inst, AbstractValue * NewV) {
     // Here OldV = f^{n-1}_{w} and NewV = f(f^{n-1}_{w})
     ////////////////////////////////////////////////////////////////////
     
-    if (I != ValueState.end() && NewV->lessOrEqual(OldV)){
+    if (OldV && NewV->lessOrEqual(OldV)){
       // No change
       DEBUG(dbgs() << "\nThere is no change\n");
-      // If uncommented then we produce a seg fault if debugging mode
-      // delete NewV
+      if (SparseNarrowing && !OldV->lessOrEqual(NewV))
+	NarrowingSeeds.set(Slot);
       return;  
     }
     
     NewV->incNumOfChanges();        
-    if (Widen(&Inst,NewV->getNumOfChanges())){
+    if (ForceTop){
+      NumOfBudgetTops++;
+      NewV->makeTop();
+    }
+    else if (Widen(Slot,NewV->getNumOfChanges())){
       //dbgs() << "WIDENING " <<  Inst << "\n";
 
       NumOfWidenings++;
-      NewV->widening(OldV,ConstSet);
+      if (WideningBudget && Slot < NumOfInstSlots && 
+	  ++NumOfWideningsAt[Slot] > WideningBudget){
+	// Out of widenings: go directly to top.
+	NumOfBudgetTops++;
+	if (!ExhaustedBudget) ExhaustedBudget = "widenings";
+	NewV->makeTop();
+      }
+      else
+	NewV->widening(OldV,Landmarks[LandmarkIndex[Slot]]);
+      if (SparseNarrowing)
+	NarrowingSeeds.set(Slot);
       // We reset the counter because we don't want to apply widening
       // if not really needed. E.g., after a widening we can have a
       // casting operation. If the counter is not reset then we will
@@ -428,52 +828,62 @@ void FixpointSSI::updateState(Instruction &Inst, AbstractValue * NewV) {
     // there is change: visit uses of I.
     assert(NewV);
 
-    delete ValueState[&Inst];
-    ValueState[&Inst] = NewV;
-    DEBUG(dbgs() << "***Added into I-WL: " << Inst << "\n");
-    InstWorkList.insert(&Inst);
+    Scratch[Slot]  = OldV;
+    AbsState[Slot] = NewV;
+    notifyChange(Slot);
   }
 }
 
 // Special case for Boolean flags.
-void FixpointSSI::updateCondFlag(Instruction &I, TBool * New){  
-  assert(isTrackedCondFlag(&I));  
+void FixpointSSI::updateCondFlag(unsigned Slot, TBool New){  
+  assert(Flags.has(Slot));  
+  TBool Old = Flags.get(Slot);
+  if (NarrowingPass && SparseNarrowing){
+    // Keep only flags that become more precise.
+    if (!New.lessOrEqual(Old) || Old.isEqual(New))
+      return;
+    Flags.set(Slot, New);
+    InstWorkList.insert(Slot);
+    return;
+  }
   if (NarrowingPass){
-    delete TrackedCondFlags[&I];
-    TrackedCondFlags[&I] = New;    
+    Flags.set(Slot, New);
     return;
   }  
-  TBool * Old = TrackedCondFlags.lookup(&I);  
-  if (Old->isEqual(New)){
+  if (Old.isEqual(New)){
     // No change
     DEBUG(dbgs() << "\nThere is no change\n");
-    //delete New;
     return;  
   }  
   // There is change: visit uses of I.
-  delete TrackedCondFlags[&I];
-  TrackedCondFlags[&I] = New;
-  DEBUG(dbgs() << "***Added into I-WL: " << I << "\n");
-  InstWorkList.insert(&I);
+  if (ForceTop)
+    New.makeMaybe();
+  Flags.set(Slot, New);
+  notifyChange(Slot);
 }
 
-// Mark the edge Source-Dest as executable and mark Dest as an
-// executable block.  Moreover, we revisit the phi nodes of Dest.
-void FixpointSSI::markEdgeExecutable(BasicBlock *Source, BasicBlock *Dest) {
-  if (!KnownFeasibleEdges.insert(std::make_pair(Source, Dest)).second)
+// Mark the edge as executable and mark its destination as an
+// executable block.  Moreover, we revisit the phi nodes of the
+// destination.
+void FixpointSSI::markEdgeExecutable(unsigned Edge) {
+  if (KnownFeasibleEdges.test(Edge))
     return;  // This edge is already known to be executable!  
+  KnownFeasibleEdges.set(Edge);
 
-  DEBUG(dbgs() << "***Marking Edge Executable: " << Source->getName()
-	       << " -> " << Dest->getName() << "\n");
-  if (BBExecutable.count(Dest) && !NarrowingPass) {
+  unsigned Dest = EdgeDest[Edge];
+  DEBUG(dbgs() << "***Marking Edge Executable to: " 
+	       << Blocks[Dest]->getName() << "\n");
+  if (BBExecutable.test(Dest) && !NarrowingPass) {
     // The destination is already executable, but we just made an edge
     // feasible that wasn't before.  Revisit the PHI nodes in the block
     // because they have potentially new operands.
-    for (BasicBlock::iterator I = Dest->begin(), E = Dest->end(); I!=E ; ++I){
-      if (isa<PHINode>(I)){
-	DEBUG(dbgs() << "Triggering the analysis of " << *I << "\n");
-	visitPHINode(*cast<PHINode>(I));    
+    for (unsigned I = BlockBegin[Dest], E = BlockBegin[Dest+1]; I != E; ++I){
+      if (PHINode *PN = dyn_cast<PHINode>(SlotValue[I])){
+	DEBUG(dbgs() << "Triggering the analysis of " << *PN << "\n");
+	visitPHINode(I, *PN);    
       }
+      else 
+	break;
     }
   } 
   else 
@@ -482,23 +892,26 @@ void FixpointSSI::markEdgeExecutable(BasicBlock *Source, BasicBlock *Dest) {
 
 // Mark a basic block as executable, adding it to the BB worklist if
 // it is not already executable.
-void FixpointSSI::markBlockExecutable(BasicBlock *BB) {
-  DEBUG(dbgs() << "***Marking Block Executable: " << BB->getName() << "\n");
+void FixpointSSI::markBlockExecutable(unsigned BB) {
+  DEBUG(dbgs() << "***Marking Block Executable: " << Blocks[BB]->getName() << "\n");
   NumOfAnalBlocks++;  
-  BBExecutable.insert(BB);   // Basic block is executable  
+  BBExecutable.set(BB);   // Basic block is executable  
 
 #ifdef SKIP_TRAP_BLOCKS
-  DenseMap<BasicBlock*,unsigned int>::iterator It = TrackedTrapBlocks.find(BB);
-  if (It != TrackedTrapBlocks.end())
+  if (TrackedTrapBlocks.test(BB))
     return;
 #endif 
   BBWorkList.insert(BB);     // Add the block to the work list
 }
 
 // visitInst - Execute the instruction
-void FixpointSSI::visitInst(Instruction &I) { 
+void FixpointSSI::visitInst(unsigned Slot) { 
 
   NumOfAnalInsts++;
+  NumOfVisits++;
+  if ((VisitBudget || TimeBudget) && !ForceTop && !NarrowingPass)
+    checkBudget();
+  Instruction &I = *cast<Instruction>(SlotValue[Slot]);
 
   // First, special instructions handled directly by the fixpoint
   // algorithm, never passed into the underlying abstract domain
@@ -508,127 +921,111 @@ void FixpointSSI::visitInst(Instruction &I) {
     return visitStoreInst(*SI);
 
   if (LoadInst *LI   = dyn_cast<LoadInst>(&I))
-    return visitLoadInst(*LI);
+    return visitLoadInst(Slot, *LI);
 
   if (CallInst *CI = dyn_cast<CallInst>(&I))
-    return visitCallInst(*CI);
+    return visitCallInst(Slot, *CI);
 
   if (ReturnInst *RI = dyn_cast<ReturnInst>(&I))
     return visitReturnInst(*RI);
 
   if (PHINode *PN = dyn_cast<PHINode>(&I))
-    return visitPHINode(*PN);
+    return visitPHINode(Slot, *PN);
 
   if (SelectInst *SelI = dyn_cast<SelectInst>(&I))
-    return visitSelectInst(*SelI);
+    return visitSelectInst(Slot, *SelI);
 
   if (TerminatorInst *TI = dyn_cast<TerminatorInst>(&I))
-    return visitTerminatorInst(*TI);
+    return visitTerminatorInst(Slot, *TI);
 
   if (ICmpInst *ICmpI = dyn_cast<ICmpInst>(&I))
-    return visitComparisonInst(*ICmpI);
+    return visitComparisonInst(Slot, *ICmpI);
   
   if (IsBooleanLogicalOperator(&I))
-    return visitBooleanLogicalInst(I);
+    return visitBooleanLogicalInst(Slot, I);
   
   // Otherwise, we pass the transfer function to the abstract domain.
-  if (Value *V = dyn_cast<Value>(&I)){
-    if (AbstractValue * AbsV = ValueState.lookup(V)){ 
-
-      // New is going to keep a pointer to a derived class. The
-      // methods visitArithBinaryOp, visitBitwiseBinaryOp, and
-      // visitCast ensure that it is new allocated memory.
-      AbstractValue *New = NULL;
-      switch (I.getOpcode()){
-      case Instruction::Add: 
-      case Instruction::Sub:
-      case Instruction::Mul:
-      case Instruction::SDiv:
-      case Instruction::UDiv:
-      case Instruction::SRem:
-      case Instruction::URem:
-	{
-	  DEBUG(dbgs() << "Arithmetic instruction: " << I << "\n");
-	  /// 
-	  // We can have instructions like 
-	  // %tmp65 = sub i32 %tmp64, ptrtoint ([6 x %struct._IO_FILE*]* @xgets.F to i32)	    
-	  // Therefore, we need to check if the operands are in
-	  // ValueState. If not, just top.
-	  ////
-	  AbstractValue * Op1 = Lookup(I.getOperand(0), false);
-	  AbstractValue * Op2 = Lookup(I.getOperand(1), false);
-	  if (Op1 && Op2)
-	    New = AbsV->visitArithBinaryOp(Op1,Op2,
-					   I.getOpcode(),I.getOpcodeName());
-	  else{
-	    New = AbsV->clone();
-	    New->makeTop();	      
-	  }
-	}
-	break;
-      case Instruction::Shl:  // logical left shift
-      case Instruction::LShr: // logical right shift    
-      case Instruction::AShr: // arithmetic right shift    
-      case Instruction::And:  // bitwise and
-      case Instruction::Or:   // bitwise or
-      case Instruction::Xor:  // bitwise xor
-	{
-	  DEBUG(dbgs() << "Bitwise instruction: " << I << "\n");
-	  AbstractValue * Op1 = Lookup(I.getOperand(0), false);
-	  AbstractValue * Op2 = Lookup(I.getOperand(1), false);
-	  if (Op1 && Op2)
-	    New =  AbsV->visitBitwiseBinaryOp(Op1, Op2,
-					      I.getOperand(0)->getType(), 
-					      I.getOperand(1)->getType(),
-					      I.getOpcode(), I.getOpcodeName());
-	  else{
-	    New = AbsV->clone();
-	    New->makeTop();	      
-	  }
-	}
-	break;
-      case Instruction::BitCast: // no-op cast from one type to another
-      case Instruction::ZExt:    // zero extend integers
-      case Instruction::SExt:    // sign extend integers
-      case Instruction::Trunc:   // truncate integers
-	{
-	  DEBUG(dbgs() << "Casting instruction: " << I << "\n");	    
-	  // Tricky step: the source of the casting instruction may be
-	  // a Boolean Flag.  If yes, we need to convert the Boolean
-	  // flag into an abstract value. This must be done by the
-	  // class that implements AbstractValue.
-	  TBool * SrcFlag  = NULL;
-	  AbstractValue *SrcAbsV = NULL;	  
-	  if (isTrackedCondFlag(I.getOperand(0)))
-	    SrcFlag = TrackedCondFlags.lookup(I.getOperand(0));
-	  else
-	    SrcAbsV = Lookup(I.getOperand(0), false);
-
-	  if (SrcFlag || SrcAbsV)
-	    New =  AbsV->visitCast(I, SrcAbsV, SrcFlag, IsAllSigned);
-	  else{
-	    New = AbsV->clone();
-	    New->makeTop();	      
-	  }
-	}
-	break;
-      default: 
+  if (AbsState[Slot]){ 
+
+    // The transfer functions store the result in the scratch value
+    // of the slot which starts as a copy of the current value.
+    AbstractValue *New = getScratch(Slot);
+    switch (I.getOpcode()){
+    case Instruction::Add: 
+    case Instruction::Sub:
+    case Instruction::Mul:
+    case Instruction::SDiv:
+    case Instruction::UDiv:
+    case Instruction::SRem:
+    case Instruction::URem:
+      {
+	DEBUG(dbgs() << "Arithmetic instruction: " << I << "\n");
+	/// 
+	// We can have instructions like 
+	// %tmp65 = sub i32 %tmp64, ptrtoint ([6 x %struct._IO_FILE*]* @xgets.F to i32)	    
+	// Therefore, we need to check if the operands are in
+	// AbsState. If not, just top.
+	////
+	AbstractValue * Op1 = getOperandAbsVal(Slot, 0);
+	AbstractValue * Op2 = getOperandAbsVal(Slot, 1);
+	if (Op1 && Op2)
+	  New->visitArithBinaryOp(Op1,Op2,
+				  I.getOpcode(),I.getOpcodeName());
+	else
+	  New->makeTop();	      
+      }
+      break;
+    case Instruction::Shl:  // logical left shift
+    case Instruction::LShr: // logical right shift    
+    case Instruction::AShr: // arithmetic right shift    
+    case Instruction::And:  // bitwise and
+    case Instruction::Or:   // bitwise or
+    case Instruction::Xor:  // bitwise xor
+      {
+	DEBUG(dbgs() << "Bitwise instruction: " << I << "\n");
+	AbstractValue * Op1 = getOperandAbsVal(Slot, 0);
+	AbstractValue * Op2 = getOperandAbsVal(Slot, 1);
+	if (Op1 && Op2)
+	  New->visitBitwiseBinaryOp(Op1, Op2,
+				    I.getOperand(0)->getType(), 
+				    I.getOperand(1)->getType(),
+				    I.getOpcode(), I.getOpcodeName());
+	else
+	  New->makeTop();	      
+      }
+      break;
+    case Instruction::BitCast: // no-op cast from one type to another
+    case Instruction::ZExt:    // zero extend integers
+    case Instruction::SExt:    // sign extend integers
+    case Instruction::Trunc:   // truncate integers
+      {
+	DEBUG(dbgs() << "Casting instruction: " << I << "\n");	    
+	// Tricky step: the source of the casting instruction may be
+	// a Boolean Flag.  If yes, we need to convert the Boolean
+	// flag into an abstract value. This must be done by the
+	// class that implements AbstractValue.
+	TBool SrcFlag;
+	bool HasSrcFlag = getOperandFlag(Slot, 0, SrcFlag);
+	AbstractValue *SrcAbsV = NULL;	  
+	if (!HasSrcFlag)
+	  SrcAbsV = getOperandAbsVal(Slot, 0);
+
+	if (HasSrcFlag || SrcAbsV)
+	  New->visitCast(I, SrcAbsV, HasSrcFlag ? &SrcFlag : NULL, IsAllSigned);
+	else
+	  New->makeTop();	      
+      }
+      break;
+    default: 
 #ifdef  WARNINGS
-	dbgs() << "Warning: transfer function not implemented: " << I << "\n"; 
+      dbgs() << "Warning: transfer function not implemented: " << I << "\n"; 
 #endif  /* WARNINGS */
-	assert(New == NULL);
-	New = AbsV->clone();
-	New->makeTop();
-	NumOfSkippedIns++;
-	break;
-      } // end switch
-      assert(New && "ERROR: something wrong during the transfer function ");
-      PRINTCALLER("visitInst");
-      // We do not delete New since it will be stored in a map
-      // manipulated by updateState. Instead, updateState will free
-      // the old value if it is replaced with New.
-      updateState(I,New);
-    }
+      New->makeTop();
+      NumOfSkippedIns++;
+      break;
+    } // end switch
+    PRINTCALLER("visitInst");
+    updateState(Slot,New);
   } 
 }
 
@@ -637,20 +1034,16 @@ void FixpointSSI::visitInst(Instruction &I) {
 /// Conservative assumptions if the code of the called function will
 /// not be analyzed.
 void FixpointSSI::
-FunctionWithoutCode(CallInst *CInst, Function * Callee, Instruction *I){
+FunctionWithoutCode(CallInst *CInst, Function * Callee, unsigned Slot){
   
   // Make top the return value if it's trackable by the analysis
-  if (!I->getType()->isVoidTy()) {
-    if (isTrackedCondFlag(I)){
-      TBool * LHSFlag = TrackedCondFlags[I];    
-      assert(LHSFlag && "ERROR: flag not found in TrackedCondFlags");
-      LHSFlag->makeMaybe();
-      DEBUG(dbgs() << "\tMaking the return value maybe: ");
-      DEBUG(LHSFlag->print(dbgs()));
-      DEBUG(dbgs() << "\n");
+  if (!CInst->getType()->isVoidTy()) {
+    if (Flags.has(Slot)){
+      Flags.set(Slot, TBool());
+      DEBUG(dbgs() << "\tMaking the return value maybe\n");
     }
     else{
-      if (AbstractValue * LHS = ValueState[I]){
+      if (AbstractValue * LHS = AbsState[Slot]){
 	DEBUG(dbgs() << "\tMaking the return value top: ");
 	LHS->makeTop();
 	DEBUG(LHS->print(dbgs()));
@@ -659,35 +1052,38 @@ FunctionWithoutCode(CallInst *CInst, Function * Callee, Instruction *I){
     }
   }  
   
-  if (Callee){
-    // Make top all global variables that may be touched by the
-    // function (CInst).
-    for (SmallPtrSet<GlobalVariable*, 64>::iterator 
-	   I = TrackedGlobals.begin(), E = TrackedGlobals.end();
-	 I != E; ++I){    
-      GlobalVariable *Gv = *I;
-      AliasAnalysis::ModRefResult IsModRef = 
-	AA->getModRefInfo(CInst,Gv,AliasAnalysis::UnknownSize);			
-      if ( (IsModRef ==  AliasAnalysis::Mod) ||
-	   (IsModRef ==  AliasAnalysis::ModRef) ){ 	
-	if (TrackedGlobals.count(Gv)){
-	  if (isTrackedCondFlag(Gv)){
-	    TBool * GvFlag = TrackedCondFlags[Gv];    
-	    assert(GvFlag && "ERROR: flag not found in TrackedCondFlags");
-	    GvFlag->makeMaybe();
-	    DEBUG(dbgs() <<"\tGlobal Boolean flag " << Gv->getName() 
-		  << " may be modified by " 
-		  << Callee->getName() <<".\n");
-	  }
-	  else{
-	    AbstractValue * AbsGv = ValueState.lookup(Gv);
-	    assert(AbsGv && "ERROR: entry not found in ValueState");
-	    AbsGv->makeTop();
-	    DEBUG(dbgs() <<"\tGlobal variable " << Gv->getName() 
-		  << " may be modified by " 
-		  << Callee->getName() <<".\n");
-	  }
-	}
+  if (Callee)
+    clobberModGlobals(CInst, Callee);
+}
+
+/// Make top all global variables that may be touched by the function
+/// (CInst).
+void FixpointSSI::clobberModGlobals(CallInst *CInst, Function *Callee){
+  for (SmallPtrSet<GlobalVariable*, 64>::iterator 
+	 I = TrackedGlobals.begin(), E = TrackedGlobals.end();
+       I != E; ++I){    
+    GlobalVariable *Gv = *I;
+    AliasAnalysis::ModRefResult IsModRef;
+    {
+      ScopedLock Lock(IRLock);
+      IsModRef = AA->getModRefInfo(CInst,Gv,AliasAnalysis::UnknownSize);
+    }
+    if ( (IsModRef ==  AliasAnalysis::Mod) ||
+	 (IsModRef ==  AliasAnalysis::ModRef) ){ 	
+      unsigned GvSlot = getSlot(Gv);
+      if (Flags.has(GvSlot)){
+	Flags.set(GvSlot, TBool());
+	DEBUG(dbgs() <<"\tGlobal Boolean flag " << Gv->getName() 
+	      << " may be modified by " 
+	      << Callee->getName() <<".\n");
+      }
+      else{
+	AbstractValue * AbsGv = AbsState[GvSlot];
+	assert(AbsGv && "ERROR: entry not found in AbsState");
+	AbsGv->makeTop();
+	DEBUG(dbgs() <<"\tGlobal variable " << Gv->getName() 
+	      << " may be modified by " 
+	      << Callee->getName() <<".\n");
       }
     }
   }
@@ -696,16 +1092,193 @@ FunctionWithoutCode(CallInst *CInst, Function * Callee, Instruction *I){
 /// Since the analysis is intraprocedural we don't analysis the
 /// callee.  We just consider the most pessimistic assumptions about
 /// the callee: top for the return value and anything memory location
-/// may-touched by the callee.
-void FixpointSSI::visitCallInst(CallInst &CI) { 
+/// may-touched by the callee. If the callee has a summary then we use
+/// it for the return value.
+void FixpointSSI::visitCallInst(unsigned Slot, CallInst &CI) { 
+  DEBUG(dbgs() << "Function call " << CI << "\n");	      
+  Function *Callee = CI.getCalledFunction();
+  if (Summaries && Callee){
+    if (SummaryTable::Entry *E = Summaries->lookup(Callee))
+      return applySummary(Slot, CI, *E);
+  }
+  FunctionWithoutCode(&CI, Callee, Slot);		       
+}
+
+/// The return value of the call is the summary of the callee. Global
+/// variables that the callee may modify are still made top.
+void FixpointSSI::applySummary(unsigned Slot, CallInst &CI, 
+			       SummaryTable::Entry &E){
+  if (Flags.has(Slot)){
+    if (!Flags.get(Slot).isEqual(E.Flag))
+      updateCondFlag(Slot, E.Flag);
+  }
+  else if (AbsState[Slot]){
+    AbstractValue *New = getScratch(Slot);
+    New->makeBot();
+    if (E.Value)
+      New->join(E.Value);
+    DEBUG(dbgs() << "\tReturn value from the summary: ");
+    DEBUG(New->print(dbgs()));
+    DEBUG(dbgs() << "\n");
+    updateState(Slot, New);
+  }
+  if (Function *Callee = CI.getCalledFunction())
+    clobberModGlobals(&CI, Callee);
+}
+
+/// Join the abstract values returned by F into its summary.
+bool FixpointSSI::updateReturnSummary(Function *F, bool Widen){
+  SummaryTable::Entry *E = Summaries ? Summaries->lookup(F) : NULL;
+  if (!E || !F->getReturnType()->isIntegerTy()) 
+    return false;
+
+  TBool Flag(E->Flag);
+  AbstractValue *Ret = E->Value ? E->Value->clone() : NULL;
+  for (unsigned Slot=0; Slot < NumOfInstSlots; Slot++){
+    ReturnInst *RI = dyn_cast<ReturnInst>(SlotValue[Slot]);
+    if (!RI || !isExecutableInst(Slot)) continue;
+    Value *RetV = RI->getReturnValue();
+    if (!RetV || isa<UndefValue>(RetV)) continue;
+    if (isCondFlag(RetV)){
+      TBool RetFlag; // maybe
+      getTBoolfromValue(RetV, RetFlag);
+      Flag.join(&RetFlag);
+    }
+    else{
+      if (!Ret){
+	Ret = initAbsValBot(RetV);
+	Ret->makeBot();
+      }
+      if (AbstractValue *RetAbsV = Lookup(RetV, false))
+	Ret->join(RetAbsV);
+      else
+	Ret->makeTop();
+    }
+  }
+
+  bool Changed = false;
+  if (!Flag.isEqual(&E->Flag)){
+    Changed = true;
+    if (Widen) Flag.makeMaybe();
+    E->Flag = Flag;
+  }
+  if (Ret){
+    if (!E->Value || !Ret->lessOrEqual(E->Value)){
+      Changed = true;
+      if (Widen) Ret->makeTop();
+      delete E->Value;
+      E->Value = Ret;
+    }
+    else
+      delete Ret;
+  }
+  DEBUG(if (Changed) { 
+      dbgs() << "Summary of " << F->getName() << ": ";
+      if (E->Value) E->Value->print(dbgs()); 
+      else E->Flag.print(dbgs());
+      dbgs() << "\n"; });
+  return Changed;
+}
 
-  CallSite *CS   = new CallSite(&CI); 
-  Function *F    = CS->getCalledFunction();
-  Instruction *I = CS->getInstruction();
+/// Join the values of the actual parameters of the calls of F into
+/// the call sites of their callees. A call site starts from the
+/// values of its first analysis and only grows afterwards so the
+/// callers of a recursive SCC can be analyzed again until no call
+/// site changes.
+bool FixpointSSI::updateCallSiteArgs(Function *F, bool Widen){
+  if (!Summaries) 
+    return false;
+  bool Changed = false;
+  for (unsigned Slot=0; Slot < NumOfInstSlots; Slot++){
+    CallInst *CI = dyn_cast<CallInst>(SlotValue[Slot]);
+    if (!CI || !isExecutableInst(Slot)) continue;
+    Function *Callee = CI->getCalledFunction();
+    SummaryTable::Entry *E = Callee ? Summaries->lookup(Callee) : NULL;
+    if (!E || !E->ArgsKnown) continue;
+
+    ScopedLock Lock(E->Lock);
+    std::pair<DenseMap<CallInst*,unsigned>::iterator,bool> It = 
+      E->CallSiteIndex.insert(std::make_pair(CI, (unsigned) E->CallSites.size()));
+    bool IsNew = It.second;
+    if (IsNew){
+      SummaryTable::CallSiteArgs *CS = new SummaryTable::CallSiteArgs();
+      CS->Values.resize(Callee->arg_size(), NULL);
+      CS->Flags.resize(Callee->arg_size());
+      E->CallSites.push_back(CS);
+      Changed = true;
+    }
+    SummaryTable::CallSiteArgs &CS = *E->CallSites[It.first->second];
+
+    for (Function::arg_iterator 
+	   argIt=Callee->arg_begin(),AE=Callee->arg_end(); argIt != AE; argIt++) {
+      unsigned k = argIt->getArgNo();
+      Value *Actual = CI->getArgOperand(k);
+      if (isCondFlag(argIt)){
+	TBool ArgFlag; // maybe
+	getTBoolfromValue(Actual, ArgFlag);
+	if (IsNew)
+	  CS.Flags[k] = ArgFlag;
+	else{
+	  ArgFlag.join(&CS.Flags[k]);
+	  if (!ArgFlag.isEqual(&CS.Flags[k])){
+	    Changed = true;
+	    if (Widen) ArgFlag.makeMaybe();
+	    CS.Flags[k] = ArgFlag;
+	  }
+	}
+	continue;
+      }
+      Type *Ty; 
+      unsigned Width;
+      if (!Utilities::getTypeAndWidth(argIt, Ty, Width)) continue;
+      AbstractValue *ActualV = Lookup(Actual, false);
+      if (!CS.Values[k]){
+	if (ActualV)
+	  CS.Values[k] = ActualV->clone();
+	else
+	  CS.Values[k] = initAbsValTop(argIt);
+	continue;
+      }
+      if (ActualV && ActualV->lessOrEqual(CS.Values[k])) continue;
+      Changed = true;
+      if (Widen || !ActualV)
+	CS.Values[k]->makeTop();
+      else
+	CS.Values[k]->join(ActualV);
+    }
+  }
+  return Changed;
+}
 
-  DEBUG(dbgs() << "Function call " << *I << "\n");	      
-  FunctionWithoutCode(&CI,F,I);		       
-  delete CS;
+/// The initial value of the formal parameter A is the join of the
+/// values of the actual parameters at the call sites of its function
+/// (bottom if there is none). For a non-lattice domain the values of
+/// all the call sites are joined at once since the binary join is not
+/// associative.
+AbstractValue* FixpointSSI::initArgFromCallSites(Argument *A, 
+						 SummaryTable::Entry &E){
+  unsigned k = A->getArgNo();
+  std::vector<AbstractValue*> Vals;
+  for (unsigned i=0, e=E.CallSites.size(); i < e; i++){
+    AbstractValue *V = E.CallSites[i]->Values[k];
+    if (V && !V->isBot())
+      Vals.push_back(V);
+  }
+  AbstractValue *Init = initAbsValBot(A, &Arena);
+  if (Vals.empty())
+    return Init;
+  Init->join(Vals[0]);
+  if (!Init->isLattice())
+    Init->GeneralizedJoin(Vals);
+  else{
+    for (unsigned i=1, e=Vals.size(); i < e; i++)
+      Init->join(Vals[i]);
+  }
+  DEBUG(dbgs() << "\tInitial value of " << A->getName() << " from " 
+	<< E.CallSites.size() << " call sites: ");
+  DEBUG(Init->print(dbgs()));
+  DEBUG(dbgs() << "\n");
+  return Init;
 }
 
 /// Do nothing.
@@ -727,6 +1300,7 @@ void FixpointSSI::addTrackedGlobalVariables(Module *M) {
     if (!Utilities::AddressIsTaken(Gv) && Gv->getType()->isPointerTy() 
 	&& Gv->getType()->getContainedType(0)->isIntegerTy()) {
       DEBUG(printValueInfo(Gv,NULL));
+      unsigned Slot = addSlot(Gv);
       // Initialize the global variable
       if (Gv->hasInitializer()){
 	if (ConstantInt * GvInitVal  = 
@@ -735,29 +1309,28 @@ void FixpointSSI::addTrackedGlobalVariables(Module *M) {
 	    DEBUG(dbgs() << "\trecording a Boolean flag for global:" 
 		  << Gv->getName() << "\n");
 	    // FIXME: we ignore the initialized value and assume "maybe"
-	      TrackedCondFlags.insert(std::make_pair(&*Gv, new TBool()));
+	    Flags.add(Slot);
 	  }
 	  else	
-	      ValueState.insert(std::make_pair(&*Gv,
-					       initAbsValIntConstant(Gv,GvInitVal)));
+	    AbsState[Slot] = initAbsValIntConstant(Gv,GvInitVal,&Arena);
 	}
       }
       else{
 	if (isCondFlag(Gv)){
 	  DEBUG(dbgs() << "\trecording a Boolean flag for global:" 
 		<< Gv->getName() << "\n");
-	  TBool * GvFlag = new TBool();
-	  GvFlag->makeFalse();	      
-	      TrackedCondFlags.insert(std::make_pair(&*Gv,GvFlag));	      
+	  TBool GvFlag;
+	  GvFlag.makeFalse();	      
+	  Flags.add(Slot, GvFlag);
 	}
 	else{
 	  ConstantInt * Zero = 
 	    cast<ConstantInt>(ConstantInt::
 			      get(Gv->getType()->getContainedType(0),
 				  0, IsAllSigned));
-	  ValueState.insert(std::make_pair(&*Gv,initAbsValIntConstant(Gv,Zero)));
-	}
+	  AbsState[Slot] = initAbsValIntConstant(Gv,Zero,&Arena);
 	}
+      }
       TrackedGlobals.insert(Gv);
     }    
   }
@@ -776,13 +1349,14 @@ void FixpointSSI::addTrackedGlobalVariablesPessimistically(Module *M) {
     if (!Utilities::AddressIsTaken(Gv) && Gv->getType()->isPointerTy() &&
 	Gv->getType()->getContainedType(0)->isIntegerTy()) {
       DEBUG(printValueInfo(Gv,NULL));
+      unsigned Slot = addSlot(Gv);
       // Initialize the global variable
       if (isCondFlag(Gv)){
 	DEBUG(dbgs() << "\trecording a Boolean flag for global:" << Gv->getName() << "\n");
-	  TrackedCondFlags.insert(std::make_pair(&*Gv,new TBool()));	      
+	Flags.add(Slot);
       }
       else
-	ValueState.insert(std::make_pair(&*Gv,initAbsValTop(Gv)));
+	AbsState[Slot] = initAbsValTop(Gv,&Arena);
       TrackedGlobals.insert(Gv);
     }    
   }
@@ -796,25 +1370,26 @@ void FixpointSSI::visitStoreInst(StoreInst &I){
   if (GlobalVariable *Gv = dyn_cast<GlobalVariable>(I.getPointerOperand())){
     if (TrackedGlobals.count(Gv)){
       // Special case if a Boolean Flag
-      if (isTrackedCondFlag(Gv)){
-	TBool * MemAddFlag = TrackedCondFlags[I.getPointerOperand()];    
-	assert(MemAddFlag && "Memory location not mapped to a Boolean flag");
+      unsigned GvSlot = getSlot(Gv);
+      if (Flags.has(GvSlot)){
 	DEBUG(dbgs() << "Memory store " << I << "\n");	  
-	if (isTrackedCondFlag(I.getValueOperand())){
-	  TBool * FlagToStore = TrackedCondFlags[I.getValueOperand()];
+	TBool MemAddFlag = Flags.get(GvSlot);
+	TBool FlagToStore;
+	if (LookupCondFlag(I.getValueOperand(), FlagToStore)){
 	  // weak update using disjunction
-	  MemAddFlag->Or(MemAddFlag,FlagToStore);
+	  MemAddFlag.Or(MemAddFlag,FlagToStore);
 	}
 	else
-	  MemAddFlag->makeMaybe();
+	  MemAddFlag.makeMaybe();
+	Flags.set(GvSlot, MemAddFlag);
 
 	DEBUG(dbgs() <<"\t[RESULT] ");
-	DEBUG(MemAddFlag->print(dbgs()));
+	DEBUG(MemAddFlag.print(dbgs()));
 	DEBUG(dbgs() <<"\n");      
 	return;
       }
       AbstractValue * MemAddr = Lookup(I.getPointerOperand(), true);
-      assert(MemAddr && "Memory location is not mapped in ValueState");	
+      assert(MemAddr && "Memory location is not mapped in AbsState");	
       DEBUG(dbgs() << "Memory store " << I << "\n");	  
       // Weak update
       MemAddr->join(Lookup(I.getValueOperand(), true));	
@@ -826,14 +1401,11 @@ void FixpointSSI::visitStoreInst(StoreInst &I){
       // FIXME: In fact we could test here if there is actually a
       // change. Otherwise, we don't need to notify anybody.
       // FIXME: maybe also other load instructions which postdominate I?
-      for (Value::use_iterator UI = I.getPointerOperand()->use_begin(), 
-	     E = I.getPointerOperand()->use_end(); UI != E; ++UI) {	  
-	Instruction *U = cast<Instruction>(*UI);
-	if (BBExecutable.count(U->getParent())){
-	  if (WideningPoints.count(U)){
-	      DEBUG(dbgs() << "***Added into I-WL: " << *U << "\n");
-	      visitInst(*U);
-	  }
+      for (unsigned u = UserBegin[GvSlot], ue = UserBegin[GvSlot+1]; u != ue; ++u){
+	unsigned U = UserSlots[u];
+	if (isExecutableInst(U) && WideningPoints.test(U)){
+	  DEBUG(dbgs() << "***Added into I-WL: " << *SlotValue[U] << "\n");
+	  visitInst(U);
 	}
       }
       return;
@@ -850,36 +1422,29 @@ void ResetAbstractValue(AbstractValue * V){
 /// Load the abstract value from the memory pointer to the lhs of the
 /// instruction and insert into the worklist all its users. We care
 /// only about tracked global variables.
-void FixpointSSI::visitLoadInst(LoadInst &I){
+void FixpointSSI::visitLoadInst(unsigned Slot, LoadInst &I){
   /// We care only about store related to tracked global variables
   if (GlobalVariable *Gv = dyn_cast<GlobalVariable>(I.getPointerOperand())){
     if (TrackedGlobals.count(Gv)){
       // Special case if a Boolean Flag
-      if (isTrackedCondFlag(Gv)){
-	TBool * LHSFlag = new TBool(*TrackedCondFlags[&I]);    
-	assert(LHSFlag && "Memory location not mapped to a Boolean flag");
-	if (isTrackedCondFlag(I.getPointerOperand())){
-	  TBool * MemAddFlag = TrackedCondFlags[I.getPointerOperand()];
-	  LHSFlag->makeTrue();
-	  LHSFlag->And(LHSFlag,MemAddFlag);
-	}
-	else
-	  LHSFlag->makeMaybe();
-	// We do not delete LHSFlag since it will be stored in a map
-	// manipulated by updateCondFlag. Instead, updateCondFlag will
-	// free the old value if it is replaced with LHSFlag.
-	updateCondFlag(I,LHSFlag);
+      TBool MemAddFlag;
+      if (LookupCondFlag(Gv, MemAddFlag)){
+	assert(Flags.has(Slot) && "Memory location not mapped to a Boolean flag");
+	TBool LHSFlag;
+	LHSFlag.makeTrue();
+	LHSFlag.And(LHSFlag,MemAddFlag);
+	updateCondFlag(Slot,LHSFlag);
 	DEBUG(dbgs() << "\t[RESULT] ");
-	DEBUG(LHSFlag->print(dbgs()));
+	DEBUG(LHSFlag.print(dbgs()));
 	DEBUG(dbgs() << "\n");            
 	return;
       }
      
-      AbstractValue * LHS = Lookup(&I, false);
-      if (!LHS) return;
+      if (!AbsState[Slot]) return;
       DEBUG(dbgs() << "Memory Load " << I << "\n");	  
-      // Clone LHS in order to compare with old value in updateState
-      AbstractValue * NewLHS = LHS->clone();        
+      // Work on the scratch value to compare with old value in
+      // updateState
+      AbstractValue * NewLHS = getScratch(Slot);
       // Assign from memory to lhs
       ResetAbstractValue(NewLHS);
       NewLHS->join(Lookup(I.getPointerOperand(), true));      
@@ -889,17 +1454,14 @@ void FixpointSSI::visitLoadInst(LoadInst &I){
       // Compare if it loads a new value and then add I into the
       // worklist
       PRINTCALLER("visitLoadInst");
-      // We do not delete NewLHS since it will be stored in a map
-      // manipulated by updateState. Instead, updateState will free
-      // the old value if it is replaced with NewLHS.
-      updateState(I,NewLHS);
+      updateState(Slot,NewLHS);
       return;
     }
   } 
   DEBUG(dbgs() << "Ignored memory load " << I << "\n");	  
-  AbstractValue * LHS = Lookup(&I, false);
   // No need to call updateState since it's top from the beginning.
-  if (LHS) LHS->makeTop();
+  if (AbstractValue * LHS = AbsState[Slot]) 
+    LHS->makeTop();
 }
 
 // Execution of sigma nodes 
@@ -1183,8 +1745,9 @@ bool FixpointSSI::evalFilter(AbstractValue * &LHSSigma, Value *RHSSigma){
 //   return FilteredDone;
 // }
 
-/// Simply assign RHSSigma to LHSSigma.
-void FixpointSSI::visitSigmaNode(AbstractValue *LHSSigma, Value * RHSSigma){
+/// Simply assign RHSSigma (operand 0 of the sigma node in Slot) to
+/// LHSSigma.
+void FixpointSSI::visitSigmaNode(AbstractValue *LHSSigma, unsigned Slot){
   // In programs like 176.gcc we have things like:
   //  %.01.i = phi i32 [ ptrtoint (double* getelementptr inbounds 
   //                     (%struct.fooalign* null, i32 0, i32 1) to i32), 
@@ -1192,32 +1755,24 @@ void FixpointSSI::visitSigmaNode(AbstractValue *LHSSigma, Value * RHSSigma){
   // Thus, we can raise an exception if RHSSigma is not found.
 
   ResetAbstractValue(LHSSigma);
-  if (AbstractValue *AbsVal = Lookup(RHSSigma,false))
+  if (AbstractValue *AbsVal = getOperandAbsVal(Slot,0))
     LHSSigma->join(AbsVal);
   else
     LHSSigma->makeTop();
 }
 
-// Execute a sigma node in two steps. The execution consists of
-// assigning RHSSigma to LHSSigma. Additionally, knowledge from BI is
-// used to improve LHSSigma. First it generates any filter that it can
-// be inferred from the branch condition. Second, it actually executes
-// the filter.
-void FixpointSSI::visitSigmaNode(AbstractValue *LHSSigma, Value * RHSSigma,
+// Execute a sigma node. The execution consists of assigning RHSSigma
+// to LHSSigma. Additionally, knowledge from BI is used to improve
+// LHSSigma by executing the filter inferred from the branch condition
+// (filters are generated once in init by addSigmaFilters).
+void FixpointSSI::visitSigmaNode(AbstractValue *LHSSigma, unsigned Slot,
 				 BasicBlock *SigmaBB, BranchInst * BI){				 
-  // FiltersTy filters;
-  // generateFilters(LHSSigma->getValue(), RHSSigma, BI, SigmaBB, filters);
-
-  SigmaFiltersTy::iterator I = SigmaFilters.find(LHSSigma->getValue());
-  if (I == SigmaFilters.end())
-    generateFilters(LHSSigma->getValue(), RHSSigma, BI, SigmaBB);
-
-  
+  Value *RHSSigma = cast<PHINode>(SlotValue[Slot])->getIncomingValue(0);
   if (!evalFilter(LHSSigma, RHSSigma /*, filters*/)){
     // Assign RHSSigma to LHSSigma
     ResetAbstractValue(LHSSigma);
     // LHSSigma->join(Lookup(RHSSigma,true));
-    if (AbstractValue * AbsVal = Lookup(RHSSigma,false))
+    if (AbstractValue * AbsVal = getOperandAbsVal(Slot,0))
       LHSSigma->join(AbsVal);
     else
       LHSSigma->makeTop();
@@ -1236,15 +1791,16 @@ void FixpointSSI::visitSigmaNode(AbstractValue *LHSSigma, Value * RHSSigma,
 /// incoming values and put them into a vector which is passed
 /// directly to the non-lattice domain which knows how to deal with
 /// this lack of associativity.
-void FixpointSSI::visitPHINode(AbstractValue *&AbsValNew, PHINode &PN){
+void FixpointSSI::visitPHINode(AbstractValue *&AbsValNew, unsigned Slot, 
+			       PHINode &PN){
 
   bool must_be_top=false;
   std::vector<AbstractValue*> AbsIncVals;
   
   for (unsigned i=0, num_vals=PN.getNumIncomingValues(); i != num_vals;i++) {
-    if (isEdgeFeasible(PN.getIncomingBlock(i), PN.getParent()) && 
+    if (isEdgeFeasible(OperandEdges[OperandBegin[Slot]+i]) && 
 	(PN.getIncomingValue(i)->getValueID() != Value::UndefValueVal)){				   
-      AbstractValue * AbsIncVal = Lookup(PN.getIncomingValue(i),false);
+      AbstractValue * AbsIncVal = getOperandAbsVal(Slot,i);
       if (!AbsIncVal){
 	must_be_top = true;
 	break;
@@ -1259,7 +1815,7 @@ void FixpointSSI::visitPHINode(AbstractValue *&AbsValNew, PHINode &PN){
     AbsValNew->GeneralizedJoin(AbsIncVals);
   
   PRINTCALLER("visitPHI");
-  updateState(PN,AbsValNew);
+  updateState(Slot,AbsValNew);
   DEBUG(dbgs() << "\t[RESULT] ");
   DEBUG(AbsValNew->print(dbgs()));
   DEBUG(dbgs() << "\n");        
@@ -1276,90 +1832,75 @@ void FixpointSSI::visitPHINode(AbstractValue *&AbsValNew, PHINode &PN){
 /// If a phi node then it merges the values only from feasible
 /// predecessors.
 
-void FixpointSSI::visitPHINode(PHINode &PN) {
-  if (Value *V = dyn_cast<Value>(&PN)){
-    if (AbstractValue * AbsVal = Lookup(V, false)){       
-      if (PN.getNumIncomingValues() == 1){
-	// Sigma node is represented as a phi node with exactly one
-	// incoming value.
-	DEBUG(dbgs() << "Sigma node " << PN << "\n");
-	AbstractValue * NewAbsVal = AbsVal->clone();  	
-	if (TerminatorInst * TI  = PN.getIncomingBlock(0)->getTerminator()){
-	  if (BranchInst * BI  = dyn_cast<BranchInst>(TI)){
-	    //assert(BI->isConditional());
-	    if (BI->isConditional())
-	      visitSigmaNode(NewAbsVal, PN.getIncomingValue(0), PN.getParent(), BI);
-	    else
-	      visitSigmaNode(NewAbsVal, PN.getIncomingValue(0));
-	  }
+void FixpointSSI::visitPHINode(unsigned Slot, PHINode &PN) {
+  if (AbsState[Slot]){       
+    if (PN.getNumIncomingValues() == 1){
+      // Sigma node is represented as a phi node with exactly one
+      // incoming value.
+      DEBUG(dbgs() << "Sigma node " << PN << "\n");
+      AbstractValue * NewAbsVal = getScratch(Slot);
+      if (TerminatorInst * TI  = PN.getIncomingBlock(0)->getTerminator()){
+	if (BranchInst * BI  = dyn_cast<BranchInst>(TI)){
+	  //assert(BI->isConditional());
+	  if (BI->isConditional())
+	    visitSigmaNode(NewAbsVal, Slot, PN.getParent(), BI);
+	  else
+	    visitSigmaNode(NewAbsVal, Slot);
 	}
-	PRINTCALLER("visitSigmaNode");
-	// We do not delete NewAbsVal since it will be stored in a map
-	// manipulated by updateState. Instead, updateState will free
-	// the old value if it is replaced with NewAbsVal.
-	updateState(PN,NewAbsVal);
+      }
+      PRINTCALLER("visitSigmaNode");
+      updateState(Slot,NewAbsVal);
 
+      DEBUG(dbgs() << "\t[RESULT] ");
+      DEBUG(NewAbsVal->print(dbgs()));
+      DEBUG(dbgs() << "\n");        
+    } 
+    else{
+      // PHI node
+      AbstractValue *AbsValNew = getScratch(Slot);
+      //ResetAbstractValue(AbsValNew);
+      AbsValNew->makeBot();
+
+      DEBUG(dbgs() << "PHI node " << PN << "\n");
+
+      // If the abstract domain is not a lattice then we call go
+      // GeneralizedJoin, a special version, for joining multiple
+      // abstract values. If the abstract domain is a lattice we
+      // don't need such a specialized method since we can use the
+      // binary join repeatedly without losing precision. For a
+      // non-lattice domain is not the case (see our SAS'13 paper).
+      if (!(AbsValNew->isLattice()))
+	visitPHINode(AbsValNew,Slot,PN);
+      else{	  
+	for (unsigned i=0, num_vals=PN.getNumIncomingValues(); i != num_vals;i++) {
+	  if (isEdgeFeasible(OperandEdges[OperandBegin[Slot]+i]) && 
+	      (PN.getIncomingValue(i)->getValueID() != Value::UndefValueVal)){				   
+	    /// Merging values: since join can only lose precision
+	    /// we stop if we already reach top.
+	      
+	    if (AbsValNew->IsTop()){ 
+	      DEBUG(dbgs() << "Skipped " << *(PN.getIncomingValue(i)) 
+		           << " because already top!\n");
+	      break;	       
+	    }
+	    AbstractValue * AbsIncVal = getOperandAbsVal(Slot,i);
+	    DEBUG(dbgs() << "Merging " << *(PN.getIncomingValue(i)) << "\n");
+	    if (!AbsIncVal){
+	      AbsValNew->makeTop();
+	      DEBUG(dbgs() << "Could not find " << *(PN.getIncomingValue(i)) 
+		           << " in the lookup table. \n");
+	      break;
+	    }
+	    else
+	      AbsValNew->join(AbsIncVal);
+	  }
+	} // end for
+	PRINTCALLER("visitPHI");
+	updateState(Slot,AbsValNew);
 	DEBUG(dbgs() << "\t[RESULT] ");
-	DEBUG(NewAbsVal->print(dbgs()));
+	DEBUG(AbsValNew->print(dbgs()));
 	DEBUG(dbgs() << "\n");        
       } 
-      else{
-	// PHI node
-	AbstractValue *AbsValNew = AbsVal->clone();
-	//ResetAbstractValue(AbsValNew);
-	AbsValNew->makeBot();
-
-	DEBUG(dbgs() << "PHI node " << PN << "\n");
-
-	// If the abstract domain is not a lattice then we call go
-	// GeneralizedJoin, a special version, for joining multiple
-	// abstract values. If the abstract domain is a lattice we
-	// don't need such a specialized method since we can use the
-	// binary join repeatedly without losing precision. For a
-	// non-lattice domain is not the case (see our SAS'13 paper).
-	if (!(AbsValNew->isLattice()))
-	  visitPHINode(AbsValNew,PN);
-	else{	  
-	  for (unsigned i=0, num_vals=PN.getNumIncomingValues(); i != num_vals;i++) {
-	    // if (!isEdgeFeasible(PN.getIncomingBlock(i), PN.getParent()))
-	    //   dbgs() << PN.getIncomingBlock(i)->getName()
-	    // 	     << " --> " << PN.getParent()->getName()  << " IS UNREACHABLE\n";
-	    // else{
-	    //   dbgs() << PN.getIncomingBlock(i)->getName() 
-	    // 	     << " --> " << PN.getParent()->getName()  << " IS REACHABLE\n";
-	    // }
-	    if (isEdgeFeasible(PN.getIncomingBlock(i), PN.getParent()) && 
-		(PN.getIncomingValue(i)->getValueID() != Value::UndefValueVal)){				   
-	      /// Merging values: since join can only lose precision
-	      /// we stop if we already reach top.
-	      
-	      if (AbsValNew->IsTop()){ 
-		DEBUG(dbgs() << "Skipped " << *(PN.getIncomingValue(i)) 
-		             << " because already top!\n");
-		break;	       
-	      }
-	      AbstractValue * AbsIncVal = Lookup(PN.getIncomingValue(i),false);
-	      DEBUG(dbgs() << "Merging " << *(PN.getIncomingValue(i)) << "\n");
-	      if (!AbsIncVal){
-		AbsValNew->makeTop();
-		DEBUG(dbgs() << "Could not find " << *(PN.getIncomingValue(i)) 
-		             << " in the lookup table. \n");
-		break;
-	      }
-	      else
-		AbsValNew->join(AbsIncVal);
-	    }
-	  } // end for
-	  PRINTCALLER("visitPHI");
-	  // We do not delete NewAbsVal since it will be stored in a map
-	  // manipulated by updateState. Instead, updateState will free
-	  // the old value if it is replaced with NewAbsVal.
-	  updateState(PN,AbsValNew);
-	  DEBUG(dbgs() << "\t[RESULT] ");
-	  DEBUG(AbsValNew->print(dbgs()));
-	  DEBUG(dbgs() << "\n");        
-	} 
-      }
     }
   }
 }
@@ -1368,53 +1909,51 @@ void FixpointSSI::visitPHINode(PHINode &PN) {
 /// lhs. If it is known whether the condition is true or false the
 /// join can be refined. We have a separate treatment if the operands
 /// are Boolean flags.
-void FixpointSSI::visitSelectInst(SelectInst &Ins){
+void FixpointSSI::visitSelectInst(unsigned Slot, SelectInst &Ins){
   DEBUG(dbgs() << "Select Instruction " << Ins << "\n");
 
+  // Operands of select are: condition, true value and false value.
   // Special case: SelectInst involves only Boolean flags
-  if  (TrackedCondFlags.lookup(&Ins)){     
-    // Make sure we make a copy here
-    TBool *LHS = new TBool(*TrackedCondFlags.lookup(&Ins));    
-    if  (TBool * Cond  = TrackedCondFlags.lookup(Ins.getCondition())){
-      if (TBool * True  = getTBoolfromValue(Ins.getTrueValue())){
-	if (TBool * False = getTBoolfromValue(Ins.getFalseValue())){     
-	  if (Cond->isTrue()){
-	    LHS->makeTrue();
-	    LHS->And(LHS,True);
+  if  (Flags.has(Slot)){     
+    TBool LHS, Cond, True, False;
+    if  (getOperandFlag(Slot,0,Cond)){
+      if (getTBoolfromOperand(Slot,1,True)){
+	if (getTBoolfromOperand(Slot,2,False)){     
+	  if (Cond.isTrue()){
+	    LHS.makeTrue();
+	    LHS.And(LHS,True);
 	  }
 	  else{
-	    if (Cond->isFalse()){
-	      LHS->makeTrue();
-	      LHS->And(LHS,False);
+	    if (Cond.isFalse()){
+	      LHS.makeTrue();
+	      LHS.And(LHS,False);
 	    }
 	    else 
-	      LHS->Or(True,False);
+	      LHS.Or(True,False);
 	  }
 	  goto BOOL_END;	  
 	}
       }
     }
     // Some of the operands is not trackable but LHS is
-    LHS->makeMaybe();
+    LHS.makeMaybe();
   BOOL_END:
-    // We do not delete LHS since it will be stored in a map
-    // manipulated by updateCondFlag. Instead, updateCondFlag will
-    // free the old value if it is replaced with LHS.
-    updateCondFlag(Ins,LHS);
+    updateCondFlag(Slot,LHS);
     DEBUG(dbgs() << "\t[RESULT] ");
-    DEBUG(LHS->print(dbgs()));
+    DEBUG(LHS.print(dbgs()));
     DEBUG(dbgs() << "\n");        
     return;
   }
 
   // General case: all the operands are AbstractValue objects
 
-  // Important: clone here to be able to compare old value later.
-  AbstractValue * OldLHS = Lookup(&Ins, false);
-  if (!OldLHS) return;   
-  AbstractValue * LHS   = OldLHS->clone();  
-  AbstractValue * True  = Lookup(Ins.getTrueValue(), false);
-  AbstractValue * False = Lookup(Ins.getFalseValue(), false);
+  // Important: work on the scratch value to be able to compare with
+  // the old value later.
+  if (!AbsState[Slot]) return;   
+  AbstractValue * LHS   = getScratch(Slot);
+  AbstractValue * True  = getOperandAbsVal(Slot,1);
+  AbstractValue * False = getOperandAbsVal(Slot,2);
+  TBool Cond;
 
   // FIXME: we can have instructions like:
   // %tmp128 = select i1 %tmp126, i32 -1, i32 %tmp127
@@ -1425,18 +1964,17 @@ void FixpointSSI::visitSelectInst(SelectInst &Ins){
   }
 
   ResetAbstractValue(LHS);  
-  if (!isTrackedCondFlag(Ins.getCondition())){
+  if (!getOperandFlag(Slot,0,Cond)){
     // The condition is not trackable as a Boolean Flag so we join
     // both
     LHS->join(True);
     LHS->join(False);    
   }
   else{   
-      TBool * Cond = TrackedCondFlags.lookup(Ins.getCondition());
-      if (Cond->isTrue())    // must be true
+      if (Cond.isTrue())    // must be true
 	LHS->join(True);
       else{
-	if (Cond->isFalse()) // must be false
+	if (Cond.isFalse()) // must be false
 	  LHS->join(False);
 	else{                // maybe
 	  LHS->join(True);
@@ -1446,11 +1984,7 @@ void FixpointSSI::visitSelectInst(SelectInst &Ins){
   }
  END_GENERAL:
   PRINTCALLER("visitSelectInst");
-
-  // We do not delete LHS since it will be stored in a map
-  // manipulated by updateState. Instead, updateState will free
-  // the old value if it is replaced with LHS.
-  updateState(Ins,LHS);
+  updateState(Slot,LHS);
   DEBUG(dbgs() << "\t[RESULT] ");
   DEBUG(LHS->print(dbgs()));
   DEBUG(dbgs() << "\n");          
@@ -1461,65 +1995,70 @@ void FixpointSSI::visitSelectInst(SelectInst &Ins){
 // the terminator.  We cover for now IndirectBrInst (we always add all
 // successors), SwitchInst, and BranchInst. This procedure is vital to
 // improve accuracy of the analysis.
-void FixpointSSI::visitTerminatorInst(TerminatorInst &TI){
+void FixpointSSI::visitTerminatorInst(unsigned Slot, TerminatorInst &TI){
 
   assert(! (isa<SwitchInst>(&TI)) && 
 	 "The program should not have switch (-lowerswitch)");
   assert(! (isa<IndirectBrInst>(&TI)) && 
 	 "The program should not have indirect branches");
 
+  // Edges to the successors of the block.
+  unsigned B = InstBlock[Slot];
+  unsigned Edge0 = EdgeBegin[B];
   if (BranchInst * Branch = dyn_cast<BranchInst>(&TI)){
     if (Branch->isUnconditional()){
       DEBUG(dbgs() << "Unconditional branch: " << *Branch << "\n") ;
       assert(Branch->getNumSuccessors() == 1);
-      markEdgeExecutable(Branch->getParent(),Branch->getSuccessor(0));
+      markEdgeExecutable(Edge0);
       return;
     } // End Unconditional Branch
 
     DEBUG(dbgs() << "Conditional branch: " << *Branch << "\n") ;
     assert(Branch->getNumSuccessors() == 2);
+    // If both successors are the same block they share the first edge.
+    unsigned Edge1 = getEdge(EdgeBegin, EdgeDest, B, EdgeDest[Edge0+1]);
 
     // Special cases if constants true or false
     if (isTrueConstant(Branch->getCondition())){
       DEBUG(dbgs() << "\tthe branch condition is MUST BE TRUE.\n") ;
-      markEdgeExecutable(Branch->getParent(),Branch->getSuccessor(0));
+      markEdgeExecutable(Edge0);
       return;
     }
     if (isFalseConstant(Branch->getCondition())){
       DEBUG(dbgs() << "\tthe branch condition is MUST BE FALSE.\n") ;		    
-      markEdgeExecutable(Branch->getParent(),Branch->getSuccessor(1));		
+      markEdgeExecutable(Edge1);		
       return;
     }
 
     // We do not keep track of the flag so everything can happen
-    if (!isTrackedCondFlag(Branch->getCondition())){
+    TBool Cond;
+    if (!getOperandFlag(Slot,0,Cond)){
 	DEBUG(dbgs() << "\tthe branch condition is MAY-TRUE/MAY-FALSE.\n") ;
-	markEdgeExecutable(Branch->getParent(),Branch->getSuccessor(0));
-	markEdgeExecutable(Branch->getParent(),Branch->getSuccessor(1));
+	markEdgeExecutable(Edge0);
+	markEdgeExecutable(Edge1);
 	return;
     }    
 
-    TBool * Cond = TrackedCondFlags.lookup(Branch->getCondition());    
-    if (Cond->isBottom()){
+    if (Cond.isBottom()){
       DEBUG(dbgs() << "\tthe branch condition is BOTTOM!\n") ;
       DEBUG(dbgs() << "\tthe successors are UNREACHABLE!\n") ;
       return;
     }
 
-    if (Cond->isMaybe()){
+    if (Cond.isMaybe()){
       DEBUG(dbgs() << "\tthe branch condition is MAYBE TRUE OR FALSE.\n") ;
-      markEdgeExecutable(Branch->getParent(),Branch->getSuccessor(0));
-      markEdgeExecutable(Branch->getParent(),Branch->getSuccessor(1));
+      markEdgeExecutable(Edge0);
+      markEdgeExecutable(Edge1);
       return;
     }
-    if (Cond->isTrue()){
+    if (Cond.isTrue()){
       DEBUG(dbgs() << "\tthe branch condition is MUST BE TRUE.\n") ;
-      markEdgeExecutable(Branch->getParent(),Branch->getSuccessor(0));
+      markEdgeExecutable(Edge0);
       return;
     }
-    if (Cond->isFalse()){
+    if (Cond.isFalse()){
       DEBUG(dbgs() << "\tthe branch condition is MUST BE FALSE.\n") ;		    
-      markEdgeExecutable(Branch->getParent(),Branch->getSuccessor(1));		
+      markEdgeExecutable(Edge1);		
       return;
     }      
   } // End BranchInst
@@ -1535,34 +2074,6 @@ void FixpointSSI::visitTerminatorInst(TerminatorInst &TI){
   llvm_unreachable("Found an unsupported terminator instruction.");
 }
 
-// Reduce the number of cases. After calling getPredicate and
-// swap, only six cases: EQ, NEQ, SLE, ULE, ULT, and SLT
-// 
-// Important: for some reason if an instruction is swap it may disable
-// some def-use chains. This causes to reach too early fixpoints
-// (e.g., test-unbounded-loop-3.c). This weird behaviour is not
-// documented so it's hard to see why. Our solution is to clone the
-// instruction which we want to swap. However, we have to be careful
-// since if we try to lookup in one of our tables using that cloned
-// instruction the search will fail.
-ICmpInst * normalizeCmpInst(ICmpInst &I){
-  ICmpInst *II = cast<ICmpInst>(I.clone());
-  switch (II->getPredicate()){
-  case ICmpInst::ICMP_UGT:	
-  case ICmpInst::ICMP_SGT:	
-    II->swapOperands();
-    break;
-  case ICmpInst::ICMP_UGE:	
-  case ICmpInst::ICMP_SGE:	
-    II->swapOperands();
-    break;
-  default: 
-    ;
-  }
-  return II;
-}
-
-
 void comparisonEqInst(TBool &LHS, 
 		      AbstractValue *I1, AbstractValue *I2, 
 		      bool meetIsBottom, unsigned OpCode){
@@ -1645,39 +2156,30 @@ void  comparisonUltInst(TBool &LHS, AbstractValue *V1, AbstractValue*V2){
 /// between the two abstract values is bottom.  The wrapper is needed
 /// to make sure that the meet method is called by a non-constant
 /// value.
-bool IsMeetEmpty(AbstractValue *V1,AbstractValue* V2){
+bool FixpointSSI::IsMeetEmpty(unsigned Slot, AbstractValue *V1, AbstractValue *V2){
   if (V1->isConstant() && V2->isConstant())
     return (!V1->isIdentical(V2));
-  else{
-    if (!V1->isConstant()){
-      AbstractValue *Meet = V1->clone();
-      Meet->meet(V1,V2);
-      bool result = Meet->isBot();
-      delete Meet;
-      return result;
-    }
-    else{      
-      AbstractValue *Meet = V2->clone();
-      Meet->meet(V1,V2);
-      bool result = Meet->isBot();
-      delete Meet;
-      return result;
-    }
-  }
+  // The comparison Slot is a flag so its scratch value is free to
+  // hold the meet. It is allocated only the first time.
+  AbstractValue *NonConst = (V1->isConstant() ? V2 : V1);
+  AbstractValue *&Meet = Scratch[Slot];
+  if (!Meet)
+    Meet = NonConst->clone(Arena);
+  else
+    Meet->assign(NonConst);
+  Meet->meet(V1,V2);
+  return Meet->isBot();
 }
 
 ///  Execute a comparison instruction and store the result: "must
 ///  true", "must false", or "maybe" in the abstract value of the lhs
 ///  which must be a TBool object.
-void FixpointSSI::visitComparisonInst(ICmpInst &I){
+void FixpointSSI::visitComparisonInst(unsigned Slot, ICmpInst &I){
 
   DEBUG(dbgs() << "Comparison instruction: " << I << "\n");
-  if (!isTrackedCondFlag(&I)) return;
-  // May swap operands of I: don't do lookups using ClonedI as a base
-  // pointer !!
-  ICmpInst* ClonedI = normalizeCmpInst(I);    
-  // Make sure we make a copy here
-  TBool *LHS = new TBool(*TrackedCondFlags.lookup(&I));
+  if (!Flags.has(Slot)) return;
+  const CmpDescriptor &D = CmpDescs[Slot];
+  TBool LHS;
 
   ///////////////////////////////////////////////////////////////////////////////
   // The operands of the ICmpInst could be actually anything. E.g.,
@@ -1685,42 +2187,42 @@ void FixpointSSI::visitComparisonInst(ICmpInst &I){
   // %tmp37 = icmp ult double* %table.0, getelementptr inbounds ([544
   // x double]* @decwin, i32 0, i32 528) 
   //
-  // Here the operands are not in ValueState. Thus, we cannot raise an
+  // Here the operands are not in AbsState. Thus, we cannot raise an
   // assertion in that case. Instead, we just make "maybe" the lhs of
   // the instruction.
   ///////////////////////////////////////////////////////////////////////////////
-  if (AbstractValue *Op1 = Lookup(ClonedI->getOperand(0), false)){
-    if (AbstractValue *Op2 = Lookup(ClonedI->getOperand(1), false)){
+  if (AbstractValue *Op1 = (D.Op1 == NoSlot ? NULL : AbsState[D.Op1])){
+    if (AbstractValue *Op2 = (D.Op2 == NoSlot ? NULL : AbsState[D.Op2])){
       if (Op1->isBot() || Op2->isBot()){
-	// LHS->makeBottom();
+	// LHS.makeBottom();
 	// It is more conservative this:
-	LHS->makeMaybe();
+	LHS.makeMaybe();
 	goto END;
       }
       if (Op1->IsTop() || Op2->IsTop()){
 	// Here is one of the operands is top we just say maybe.
-	LHS->makeMaybe();
+	LHS.makeMaybe();
 	goto END;
       }
-      // Cloned has been already normalized (removed some cases)
-      switch (ClonedI->getPredicate()){
+      // The predicate has been already normalized (removed some cases)
+      switch (D.Pred){
       case ICmpInst::ICMP_EQ:
-	comparisonEqInst(*LHS,Op1,Op2,IsMeetEmpty(Op1,Op2),ICmpInst::ICMP_EQ);
+	comparisonEqInst(LHS,Op1,Op2,IsMeetEmpty(Slot,Op1,Op2),ICmpInst::ICMP_EQ);
 	break;
       case ICmpInst::ICMP_NE:
-	comparisonEqInst(*LHS,Op1,Op2,IsMeetEmpty(Op1,Op2),ICmpInst::ICMP_NE);
+	comparisonEqInst(LHS,Op1,Op2,IsMeetEmpty(Slot,Op1,Op2),ICmpInst::ICMP_NE);
 	break;
       case ICmpInst::ICMP_ULE:	  
-	comparisonUleInst(*LHS,Op1, Op2);
+	comparisonUleInst(LHS,Op1, Op2);
 	break;
       case ICmpInst::ICMP_ULT:	  
-	comparisonUltInst(*LHS,Op1, Op2);
+	comparisonUltInst(LHS,Op1, Op2);
 	break;
       case ICmpInst::ICMP_SLE:	  
-	comparisonSleInst(*LHS,Op1, Op2);
+	comparisonSleInst(LHS,Op1, Op2);
 	break;
       case ICmpInst::ICMP_SLT:	  
-	comparisonSltInst(*LHS,Op1, Op2);
+	comparisonSltInst(LHS,Op1, Op2);
 	break;
       default:
 	llvm_unreachable("ERROR: uncovered comparison operator");
@@ -1729,49 +2231,41 @@ void FixpointSSI::visitComparisonInst(ICmpInst &I){
     }
   }
   // If this point is reachable is because either V1 or v2 were not
-  // found in ValueState.
-  LHS->makeMaybe();
+  // found in AbsState.
+  LHS.makeMaybe();
 
  END:  
-  delete ClonedI;      
   DEBUG(dbgs() << "\t[RESULT]");
-  DEBUG(LHS->print(dbgs()));
+  DEBUG(LHS.print(dbgs()));
   DEBUG(dbgs() << "\n");          
   
-  // We do not delete LHS since it will be stored in a map manipulated
-  // by updateCondFlag. Instead, updateCondFlag will free the old
-  // value if it is replaced with LHS.
-  updateCondFlag(I,LHS);
+  updateCondFlag(Slot,LHS);
 }
 
 ///  Execute logical operations (and, or, xor) on 1-bit variables
 ///  (i.e., Boolean flag) using three-valued logic.
-void FixpointSSI::visitBooleanLogicalInst(Instruction &I){
+void FixpointSSI::visitBooleanLogicalInst(unsigned Slot, Instruction &I){
   DEBUG(dbgs() << "Boolean Logical instruction: " << I << "\n");
-  if (isTrackedCondFlag(&I)){
-    // Make sure we make a copy here
-    TBool * LHS = new TBool(*TrackedCondFlags[&I]);    
-    if (TBool *Op1 = getTBoolfromValue(I.getOperand(0))){
-      if (TBool *Op2 = getTBoolfromValue(I.getOperand(1))){
+  if (Flags.has(Slot)){
+    TBool LHS, Op1, Op2;
+    if (getTBoolfromOperand(Slot,0,Op1)){
+      if (getTBoolfromOperand(Slot,1,Op2)){
 	switch(I.getOpcode()){
 	case Instruction::And:
-	  LHS->And(Op1,Op2);
+	  LHS.And(Op1,Op2);
 	  break;
 	case Instruction::Or:
-	  LHS->Or(Op1,Op2);
+	  LHS.Or(Op1,Op2);
 	  break;
 	case Instruction::Xor:
-	  LHS->Xor(Op1,Op2);
+	  LHS.Xor(Op1,Op2);
 	  break;
 	default:
 	  llvm_unreachable("Wrong instruction in visitBooleanLogicalInst");
 	}
-	// We do not delete LHS since it will be stored in a map manipulated
-	// by updateCondFlag. Instead, updateCondFlag will free the old
-	// value if it is replaced with LHS.
-	updateCondFlag(I,LHS);
+	updateCondFlag(Slot,LHS);
 	DEBUG(dbgs() << "\t[RESULT]");
-	DEBUG(LHS->print(dbgs()));
+	DEBUG(LHS.print(dbgs()));
 	DEBUG(dbgs() << "\n");        
 	return;
       }
@@ -1782,35 +2276,17 @@ void FixpointSSI::visitBooleanLogicalInst(Instruction &I){
     // %tmp551.i = fcmp ult float %tmp13.i83.i, 1.000000e+00
     // %or.cond = and i1 %tmp547.i, %tmp551.i
     // where the lhs is a Boolean flag but the operands not.
-    LHS->makeMaybe();
+    LHS.makeMaybe();
     return;
   }
-  /*
-  if (isCondFlag(I.getOperand(0)))
-    dbgs() << I.getOperand(0)->getName() << " is a boolean flag\n";
-  else
-    dbgs() << I.getOperand(0)->getName() << " is NOT a boolean flag\n";
-  if (isCondFlag(I.getOperand(1)))
-    dbgs() << I.getOperand(1)->getName() << " is a boolean flag\n";
-  else
-    dbgs() << I.getOperand(1)->getName() << " is NOT a boolean flag\n";
-  if (isTrackedCondFlag(I.getOperand(0)))
-    dbgs() << I.getOperand(0)->getName() << " is  tracked \n";
-  else
-    dbgs() << I.getOperand(0)->getName() << " is NOT tracked\n";
-  if (isTrackedCondFlag(I.getOperand(1)))
-    dbgs() << I.getOperand(1)->getName() << " is tracked\n";
-  else
-    dbgs() << I.getOperand(1)->getName() << " is NOT tracked\n";
-  */
   llvm_unreachable("All operands must be Boolean flags that are being tracked");
 }
 
 
 // Return true iff widening can be applied 
-bool FixpointSSI::Widen(Instruction* I, unsigned NumChanges){
+bool FixpointSSI::Widen(unsigned Slot, unsigned NumChanges){
   return ( (WideningLimit > 0) && 
-	    WideningPoints.count(I) &&
+	   Slot < NumOfInstSlots && WideningPoints.test(Slot) &&
 	   (NumChanges >= WideningLimit));
 }    
 
@@ -1824,50 +2300,554 @@ bool FixpointSSI::Widen(Instruction* I, unsigned NumChanges){
 ///  Moreover, we also consider some load instructions done in the
 ///  destination block of backedges. In particular, where global
 ///  variables of interest are involved.
+///
+///  With the WTO iteration strategy the heads of the components play
+///  the role of the destination blocks of backedges.
 void FixpointSSI::addTrackedWideningPoints(Function * F){
   if (WideningLimit > 0){    
-    SmallVector<std::pair<const BasicBlock*,const BasicBlock*>, 32> BackEdges;
-    FindFunctionBackedges(*F, BackEdges);    
     // DestBackEdgeBB - Set of destination blocks of backedges
     SmallPtrSet<const BasicBlock*,16> DestBackEdgeBB;
-
-    for (SmallVector<std::pair<const BasicBlock*,const BasicBlock*>,32>::iterator 
-	   I = BackEdges.begin(),E = BackEdges.end(); I != E; ++I){
-      // DEBUG(dbgs() << "backedge from" << I->first->getName() << " to " << 
-      // 	  I->second->getName() << "\n");
-      DestBackEdgeBB.insert(I->second);    
+    if (Strategy == WTO_RECURSIVE){
+      assert(WTO && "WTO has not been computed");
+      for (WeakTopologicalOrder::iterator 
+	     I = WTO->begin(), E = WTO->end(); I != E; ++I){
+	if (I->IsHead)
+	  DestBackEdgeBB.insert(I->BB);
+      }
+    }
+    else{
+      SmallVector<std::pair<const BasicBlock*,const BasicBlock*>, 32> BackEdges;
+      FindFunctionBackedges(*F, BackEdges);    
+      for (SmallVector<std::pair<const BasicBlock*,const BasicBlock*>,32>::iterator 
+	     I = BackEdges.begin(),E = BackEdges.end(); I != E; ++I){
+	// DEBUG(dbgs() << "backedge from" << I->first->getName() << " to " << 
+	// 	  I->second->getName() << "\n");
+	DestBackEdgeBB.insert(I->second);    
+      }
     }
     
     DEBUG(dbgs() << "Widening points: \n");
-    for (inst_iterator I = inst_begin(F), E=inst_end(F) ; I != E; ++I){
+    for (unsigned Slot=0; Slot < NumOfInstSlots; Slot++){
+      Instruction *I = cast<Instruction>(SlotValue[Slot]);
+      if (!DestBackEdgeBB.count(I->getParent())) 
+	continue;
       // A phi node that is in the destination block of a backedge
-      if (PHINode *PN = dyn_cast<PHINode>(&*I)){
+      if (PHINode *PN = dyn_cast<PHINode>(I)){
 	if (PN->getNumIncomingValues() > 1){
-	  if (DestBackEdgeBB.count(PN->getParent())){
-	    DEBUG(dbgs() << "\t" << *I << "\n");
-	    NumOfWideningPts++;
-	    WideningPoints.insert(&*I);
-	  }
+	  DEBUG(dbgs() << "\t" << *I << "\n");
+	  NumOfWideningPts++;
+	  WideningPoints.set(Slot);
 	}
       }
       // A load of a global variable of interest done in the
       // destination block of a backedge
-      if (LoadInst *LoadI = dyn_cast<LoadInst>(&*I)){
+      if (LoadInst *LoadI = dyn_cast<LoadInst>(I)){
 	if (GlobalVariable * Gv = 
 	    dyn_cast<GlobalVariable>(LoadI->getPointerOperand())){
-	  if (TrackedGlobals.count(Gv) && 
-	      DestBackEdgeBB.count(I->getParent())){
+	  if (TrackedGlobals.count(Gv)){
 	    DEBUG(dbgs() << "\t" << *I << "\n");
 	    NumOfWideningPts++;
-	    WideningPoints.insert(&*I);
+	    WideningPoints.set(Slot);
 	  }
 	}
       }
     }
     DEBUG(dbgs() << "\n");
+    addWideningLandmarks();
   }  
 }
 
+/// Compute the landmarks of each widening point. The widening points
+/// of the same loop header share them. We also add the bounds of the
+/// common widths (see Utilities::recordCommonBounds).
+void FixpointSSI::addWideningLandmarks(){
+  LandmarkIndex.assign(NumOfInstSlots, NoSlot);
+  DenseMap<unsigned,unsigned> HeaderLandmarks;
+  for (int S = WideningPoints.find_first(); S != -1; 
+       S = WideningPoints.find_next(S)){
+    unsigned Header = InstBlock[S];
+    DenseMap<unsigned,unsigned>::iterator It = HeaderLandmarks.find(Header);
+    if (It != HeaderLandmarks.end()){
+      LandmarkIndex[S] = It->second;
+      continue;
+    }
+    BitVector Body;
+    getLoopBody(Header, Body);
+    // We put them into a set first to eliminate duplicates.
+    std::set<int64_t> Set;
+    Utilities::recordCommonBounds(Set);
+    for (int B = Body.find_first(); B != -1; B = Body.find_next(B)){
+      for (unsigned I = BlockBegin[B], E = BlockBegin[B+1]; I != E; ++I)
+	Utilities::recordIntegerConstants(cast<Instruction>(SlotValue[I]), Set);
+      // The comparison that guards an exit can be defined outside of
+      // the loop.
+      bool IsExit = false;
+      for (unsigned e = EdgeBegin[B]; e < EdgeBegin[B+1]; e++)
+	IsExit |= !Body.test(EdgeDest[e]);
+      BranchInst *BI = dyn_cast<BranchInst>(Blocks[B]->getTerminator());
+      if (IsExit && BI && BI->isConditional()){
+	if (ICmpInst *CI = dyn_cast<ICmpInst>(BI->getCondition()))
+	  Utilities::recordIntegerConstants(CI, Set);
+      }
+    }
+    DEBUG(dbgs() << "Landmarks of " << Blocks[Header]->getName() << ": ");
+    DEBUG(Utilities::printIntConstants(Set));
+    HeaderLandmarks[Header] = Landmarks.size();
+    LandmarkIndex[S] = Landmarks.size();
+    Landmarks.push_back(LandmarkSet());
+    if (ConstSetOrder == LESS_THAN)
+      Landmarks.back().initSigned(Set);
+    else if (ConstSetOrder == LEX_LESS_THAN)
+      Landmarks.back().initWords(Set);
+    else 
+      llvm_unreachable("Unsupported ordering");
+  }
+}
+
+/// Body of the natural loop of the block Header: Header plus the
+/// blocks reachable from it that can go back to Header without
+/// going through it. This is also valid for the heads of WTO
+/// components which may not dominate their body.
+void FixpointSSI::getLoopBody(unsigned Header, BitVector &Body){
+  BitVector Reach(Blocks.size());
+  std::vector<unsigned> Stack;
+  Reach.set(Header);
+  Stack.push_back(Header);
+  while (!Stack.empty()){
+    unsigned B = Stack.back();
+    Stack.pop_back();
+    for (unsigned e = EdgeBegin[B]; e < EdgeBegin[B+1]; e++){
+      unsigned D = EdgeDest[e];
+      if (!Reach.test(D)){
+	Reach.set(D);
+	Stack.push_back(D);
+      }
+    }
+  }
+  Body.resize(Blocks.size());
+  Body.set(Header);
+  Stack.push_back(Header);
+  while (!Stack.empty()){
+    unsigned B = Stack.back();
+    Stack.pop_back();
+    for (pred_iterator PI = pred_begin(Blocks[B]), PE = pred_end(Blocks[B]); 
+	 PI != PE; ++PI){
+      unsigned P = getBlockSlot(*PI);
+      if (P != NoSlot && Reach.test(P) && !Body.test(P)){
+	Body.set(P);
+	Stack.push_back(P);
+      }
+    }
+  }
+}
+
+/// Check the visits and time budgets of the current function. The
+/// clock is read only once every 256 visits.
+void FixpointSSI::checkBudget(){
+  if (VisitBudget && NumOfVisits > VisitBudget)
+    return exhaustBudget("visits");
+  if (TimeBudget && (NumOfVisits & 0xFF) == 0){
+    sys::TimeValue Elapsed = sys::TimeValue::now() - StartTime;
+    if (Elapsed.msec() > TimeBudget)
+      return exhaustBudget("time");
+  }
+}
+
+/// Send to top the values that are not stable yet and any value that
+/// changes from now on. Their users are still visited so the result
+/// is a (coarse) fixpoint. With the worklists the values that are not
+/// stable are those still in the worklist. With the WTO they are
+/// those of the components being stabilized, whose heads are forced
+/// to iterate their bodies once more.
+void FixpointSSI::exhaustBudget(const char *Budget){
+  DEBUG(dbgs() << "Out of " << Budget << " budget: widening to top\n");
+  ExhaustedBudget = Budget;
+  ForceTop = true;
+  std::vector<unsigned> Pending;
+  while (!InstWorkList.empty())
+    Pending.push_back(InstWorkList.pop());
+  for (unsigned i=0, e=Pending.size(); i < e; i++){
+    sendToTop(Pending[i]);
+    InstWorkList.insert(Pending[i]);
+  }
+  if (Strategy != WTO_RECURSIVE || ActiveComponents.empty())
+    return;
+  // The outermost component contains the others.
+  unsigned Outer = ActiveComponents[0];
+  for (unsigned j = Outer, e = Outer + (*WTO)[Outer].Size; j < e; j++){
+    unsigned B = getBlockSlot((*WTO)[j].BB);
+    if (!BBExecutable.test(B)) continue;
+    for (unsigned I = BlockBegin[B], E = BlockBegin[B+1]; I != E; ++I)
+      sendToTop(I);
+  }
+  for (unsigned i=0, e=ActiveComponents.size(); i < e; i++)
+    NumOfBlockChanges[getBlockSlot((*WTO)[ActiveComponents[i]].BB)]++;
+}
+
+/// Send to top the value of the instruction Slot.
+void FixpointSSI::sendToTop(unsigned Slot){
+  if (AbstractValue *AbsV = AbsState[Slot]){
+    if (!AbsV->IsTop()){
+      NumOfBudgetTops++;
+      AbsV->makeTop();
+    }
+  }
+  else if (Flags.has(Slot))
+    Flags.set(Slot, TBool());
+}
+
+// Warm start
+//
+// A snapshot of a function is a text file with:
+// \verbatim
+// wrapped-intervals-snapshot 1 <analysis name>
+// cfg <fingerprint of the CFG>
+// slots <number of instructions>
+// one line per instruction: <fingerprint> followed by
+//   -                                if not tracked
+//   v <number of changes> <value>    if it has an abstract value
+//   f <t|f|m|b>                      if it has a Boolean flag
+// blocks <one 0/1 per block: executable>
+// edges <one 0/1 per edge: feasible>
+// \endverbatim
+// Numbers are in hexadecimal.
+
+static const char *SnapshotHeader = "wrapped-intervals-snapshot 1 ";
+
+static char TBoolToChar(TBool B){
+  if (B.isTrue())   return 't';
+  if (B.isFalse())  return 'f';
+  if (B.isBottom()) return 'b';
+  return 'm';
+}
+
+static bool CharToTBool(StringRef Str, TBool *B){
+  if (Str == "t") B->makeTrue();
+  else if (Str == "f") B->makeFalse();
+  else if (Str == "b") B->makeBottom();
+  else if (Str == "m") B->makeMaybe();
+  else return false;
+  return true;
+}
+
+static void writeBits(raw_ostream &Out, const BitVector &BV){
+  for (unsigned i=0, e=BV.size(); i < e; i++)
+    Out << (BV.test(i) ? '1' : '0');
+}
+
+static bool readBits(StringRef Str, BitVector &BV){
+  if (Str.size() != BV.size()) return false;
+  for (unsigned i=0, e=Str.size(); i < e; i++){
+    if (Str[i] == '1') BV.set(i);
+    else if (Str[i] != '0') return false;
+  }
+  return true;
+}
+
+/// The name of a function may contain characters that cannot appear
+/// in a file name (e.g., '/' or ':') so the file is named after a
+/// hash of the module and the function. A collision only makes the
+/// fingerprint of the CFG, which includes the name, not match.
+std::string FixpointSSI::getSnapshotPath(Function *F){
+  Fingerprint FP;
+  FP.add(M->getModuleIdentifier());
+  FP.add(F->getName());
+  return WarmStartDir + "/" + utohexstr(FP.get()) + "." + 
+    getAnalysisName() + ".snap";
+}
+
+/// The slots of instructions depend only on the shape of the CFG so
+/// if the fingerprint of the CFG did not change we can match the
+/// instructions of both runs by slot. The initial values of the
+/// arguments are included since they may come from the call sites.
+uint64_t FixpointSSI::getCFGFingerprint(Function *F){
+  Fingerprint FP;
+  FP.add(F->getName());
+  FP.add(F->arg_size());
+  for (Function::arg_iterator 
+	 argIt=F->arg_begin(),E=F->arg_end(); argIt != E; argIt++) {
+    FP.add(argIt->getType()->getTypeID());
+    FP.add(argIt->getType()->getPrimitiveSizeInBits());
+    unsigned Slot = getSlot(argIt);
+    std::string S;
+    raw_string_ostream Out(S);
+    if (AbsState[Slot])
+      AbsState[Slot]->write(Out);
+    else if (Flags.has(Slot))
+      Out << TBoolToChar(Flags.get(Slot));
+    FP.add(Out.str());
+  }
+  FP.add(Blocks.size());
+  for (unsigned B=0, NB=Blocks.size(); B < NB; B++){
+    FP.add(BlockBegin[B+1] - BlockBegin[B]);
+    FP.add(EdgeBegin[B+1] - EdgeBegin[B]);
+    for (unsigned e=EdgeBegin[B]; e < EdgeBegin[B+1]; e++)
+      FP.add(EdgeDest[e]);
+  }
+  return FP.get();
+}
+
+/// Fingerprint of the instruction Slot. Instructions and arguments
+/// are identified by their slots and constants by their values. The
+/// fingerprint of a sigma node includes the one of the condition that
+/// filters it and the one of a call the summary of its callee.
+uint64_t FixpointSSI::getInstFingerprint(unsigned Slot){
+  Instruction *I = cast<Instruction>(SlotValue[Slot]);
+  Fingerprint FP;
+  FP.add(I->getOpcode());
+  FP.add(I->getType()->getTypeID());
+  FP.add(I->getType()->getPrimitiveSizeInBits());
+  if (CmpInst *CI = dyn_cast<CmpInst>(I))
+    FP.add(CI->getPredicate());
+  for (unsigned k=0, e=I->getNumOperands(); k < e; k++){
+    Value *Op = I->getOperand(k);
+    if (ConstantInt *C = dyn_cast<ConstantInt>(Op)){
+      FP.add('c');
+      FP.add(C->getBitWidth());
+      FP.add(C->getValue().toString(16,false));
+    }
+    else if (isa<Instruction>(Op) || isa<Argument>(Op)){
+      FP.add('s');
+      FP.add(getSlot(Op));
+    }
+    else if (BasicBlock *BB = dyn_cast<BasicBlock>(Op)){
+      FP.add('b');
+      FP.add(getBlockSlot(BB));
+    }
+    else if (Op->hasName()){
+      FP.add('n');
+      FP.add(Op->getName());
+    }
+    else
+      FP.add(Op->getValueID());
+  }
+  // The result of a call depends also on the summary of the callee.
+  if (CallInst *CI = dyn_cast<CallInst>(I)){
+    SummaryTable::Entry *E = NULL;
+    if (Summaries && CI->getCalledFunction())
+      E = Summaries->lookup(CI->getCalledFunction());
+    if (E){
+      std::string S;
+      raw_string_ostream Out(S);
+      if (E->Value) 
+	E->Value->write(Out);
+      Out << " " << E->Flag.getValue();
+      FP.add(Out.str());
+    }
+  }
+  if (PHINode *PN = dyn_cast<PHINode>(I)){
+    for (unsigned k=0, e=PN->getNumIncomingValues(); k < e; k++)
+      FP.add(getBlockSlot(PN->getIncomingBlock(k)));
+    if (PN->getNumIncomingValues() == 1){
+      BranchInst *BI = 
+	dyn_cast<BranchInst>(PN->getIncomingBlock(0)->getTerminator());
+      if (BI && BI->isConditional() && isa<Instruction>(BI->getCondition()))
+	FP.add(getInstFingerprint(getSlot(BI->getCondition())));
+    }
+  }
+  return FP.get();
+}
+
+/// Load the snapshot of F saved by a previous run, if any. Return
+/// false if there is no snapshot, it is malformed or the CFG of F
+/// changed. Otherwise, the state is restored except for the
+/// instructions whose fingerprint changed which keep their initial
+/// value and are recorded in WarmSeeds.
+bool FixpointSSI::loadSnapshot(Function *F){
+  OwningPtr<MemoryBuffer> Buffer;
+  if (MemoryBuffer::getFile(getSnapshotPath(F), Buffer))
+    return false;
+  SmallVector<StringRef, 256> Lines;
+  Buffer->getBuffer().split(Lines, "\n", -1, false);
+  if (Lines.size() != NumOfInstSlots + 5)
+    goto COLD;
+  {
+    if (Lines[0] != std::string(SnapshotHeader) + getAnalysisName())
+      goto COLD;
+    StringRef Line = Lines[1];
+    uint64_t V;
+    if (Utilities::nextToken(Line) != "cfg" || 
+	!Utilities::readHex(Line, V) || V != getCFGFingerprint(F))
+      goto COLD;
+    Line = Lines[2];
+    if (Utilities::nextToken(Line) != "slots" || 
+	!Utilities::readHex(Line, V) || V != NumOfInstSlots)
+      goto COLD;
+
+    BitVector Executable(BBExecutable.size());
+    BitVector Feasible(KnownFeasibleEdges.size());
+    Line = Lines[NumOfInstSlots+3];
+    if (Utilities::nextToken(Line) != "blocks" || !readBits(Line, Executable))
+      goto COLD;
+    Line = Lines[NumOfInstSlots+4];
+    if (Utilities::nextToken(Line) != "edges" || !readBits(Line, Feasible))
+      goto COLD;
+
+    // The restored values are read in the scratch values and the
+    // flags in a temporary copy so nothing changes until the whole
+    // file has been checked.
+    std::vector<unsigned> Changed;
+    std::vector<unsigned> RestoredValues;
+    std::vector<std::pair<unsigned,TBool> > RestoredFlags;
+    for (unsigned Slot=0; Slot < NumOfInstSlots; Slot++){
+      Line = Lines[Slot+3];
+      if (!Utilities::readHex(Line, V))
+	goto COLD;
+      StringRef Kind = Utilities::nextToken(Line);
+      if (V != getInstFingerprint(Slot) ||
+	  (Kind == "-" && (AbsState[Slot] || Flags.has(Slot))) ||
+	  (Kind == "v" && !AbsState[Slot]) ||
+	  (Kind == "f" && !Flags.has(Slot))){
+	Changed.push_back(Slot);
+	continue;
+      }
+      if (Kind == "v"){
+	uint64_t NumOfChanges;
+	AbstractValue *S = getScratch(Slot);
+	if (!Utilities::readHex(Line, NumOfChanges) || !S->read(Line))
+	  goto COLD;
+	S->setNumOfChanges(NumOfChanges);
+	RestoredValues.push_back(Slot);
+      }
+      else if (Kind == "f"){
+	TBool B;
+	if (!CharToTBool(Line, &B))
+	  goto COLD;
+	RestoredFlags.push_back(std::make_pair(Slot, B));
+      }
+      else if (Kind != "-")
+	goto COLD;
+    }
+
+    for (unsigned i=0, e=RestoredValues.size(); i < e; i++){
+      unsigned Slot = RestoredValues[i];
+      std::swap(AbsState[Slot], Scratch[Slot]);
+    }
+    for (unsigned i=0, e=RestoredFlags.size(); i < e; i++)
+      Flags.set(RestoredFlags[i].first, RestoredFlags[i].second);
+    BBExecutable = Executable;
+    KnownFeasibleEdges = Feasible;
+    WarmSeeds.swap(Changed);
+    DEBUG(dbgs() << "Warm start of " << F->getName() << ": " 
+	  << WarmSeeds.size() << " changed instructions\n");
+    return true;
+  }
+ COLD:
+  DEBUG(dbgs() << "Cold start of " << F->getName() 
+	<< ": the snapshot does not match\n");
+  return false;
+}
+
+/// Save the final state of F so that the next run can start from it.
+void FixpointSSI::saveSnapshot(Function *F){
+  bool Existed;
+  if (sys::fs::create_directories(WarmStartDir, Existed))
+    return;
+  std::string Snapshot;
+  {
+    raw_string_ostream Out(Snapshot);
+    Out << SnapshotHeader << getAnalysisName() << "\n";
+    Out << "cfg " << utohexstr(getCFGFingerprint(F)) << "\n";
+    Out << "slots " << utohexstr(NumOfInstSlots) << "\n";
+    for (unsigned Slot=0; Slot < NumOfInstSlots; Slot++){
+      Out << utohexstr(getInstFingerprint(Slot));
+      if (AbstractValue *AbsV = AbsState[Slot]){
+	Out << " v " << utohexstr(AbsV->getNumOfChanges()) << " ";
+	AbsV->write(Out);
+      }
+      else if (Flags.has(Slot))
+	Out << " f " << TBoolToChar(Flags.get(Slot));
+      else
+	Out << " -";
+      Out << "\n";
+    }
+    Out << "blocks ";
+    writeBits(Out, BBExecutable);
+    Out << "\nedges ";
+    writeBits(Out, KnownFeasibleEdges);
+    Out << "\n";
+  }
+  // A reader never sees a partial snapshot.
+  std::string Path = getSnapshotPath(F);
+  std::string ErrorInfo;
+  if (!Utilities::writeFileAtomically(Path, Snapshot, ErrorInfo))
+    dbgs() << "Warning: cannot write " << Path << ": " << ErrorInfo << "\n";
+}
+
+/// Add the final state of F to the result store. Arguments and
+/// instructions are keyed by their position in F and blocks are
+/// identified by their position in F rather than by their slots
+/// (see ResultStore.h).
+void FixpointSSI::storeResults(Function *F){
+  ResultStoreWriter::FunctionResults *R = new ResultStoreWriter::FunctionResults();
+  R->Name = F->getName();
+  // The slot of each key.
+  std::vector<unsigned> KeySlots;
+  for (Function::arg_iterator 
+	 argIt=F->arg_begin(),E=F->arg_end(); argIt != E; argIt++)
+    KeySlots.push_back(getSlot(argIt));
+  DenseMap<BasicBlock*,unsigned> BlockPos;
+  unsigned NumOfBlocks = 0;
+  for (Function::iterator BB = F->begin(), EE = F->end(); BB != EE; ++BB){
+    BlockPos[BB] = NumOfBlocks++;
+    for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I)
+      KeySlots.push_back(getSlot(I));
+  }
+
+  for (unsigned K=0, e=KeySlots.size(); K < e; K++){
+    unsigned Slot = KeySlots[K];
+    if (Slot == NoSlot) continue;
+    if (AbstractValue *AbsV = AbsState[Slot]){
+      unsigned Width = 0;
+      uint64_t Lo = 0, Hi = 0;
+      ResultKindTy Kind = RESULT_TOP;
+      if (AbsV->isBot())
+	Kind = RESULT_BOTTOM;
+      else if (!AbsV->IsTop() && AbsV->getBounds(Width, Lo, Hi))
+	Kind = RESULT_RANGE;
+      R->Values.push_back(ResultStoreWriter::ValueResult(K, Width, Kind, Lo, Hi));
+    }
+    else if (Flags.has(Slot))
+      R->Values.push_back(ResultStoreWriter::ValueResult(K, 1, RESULT_FLAG,
+							 Flags.get(Slot).getBits(), 0));
+  }
+
+  R->setNumBlocks(NumOfBlocks);
+  for (unsigned B=0, NB=Blocks.size(); B < NB; B++){
+    unsigned From = BlockPos[Blocks[B]];
+    if (BBExecutable.test(B))
+      R->setReachable(From);
+    for (unsigned e=EdgeBegin[B]; e < EdgeBegin[B+1]; e++){
+      if (KnownFeasibleEdges.test(e))
+	R->Edges.push_back(std::make_pair(From, BlockPos[Blocks[EdgeDest[e]]]));
+    }
+  }
+  Store->add(F, R);
+}
+
+/// Return true if the edge from From to To is feasible in the current
+/// function. If From has several edges to To (e.g., a lowered switch)
+/// any of them will do.
+bool FixpointSSI::IsEdgeFeasible(BasicBlock *From, BasicBlock *To) const{
+  unsigned B = getBlockSlot(From), D = getBlockSlot(To);
+  if (B == NoSlot || D == NoSlot) return false;
+  for (unsigned e=EdgeBegin[B]; e < EdgeBegin[B+1]; e++){
+    if (EdgeDest[e] == D && KnownFeasibleEdges.test(e))
+      return true;
+  }
+  return false;
+}
+
+/// Return the abstract value of every tracked value of the current
+/// function.
+AbstractStateTy FixpointSSI::getValMap() const{
+  AbstractStateTy ValMap;
+  for (unsigned i=0, e=AbsState.size(); i < e; i++){
+    if (AbsState[i])
+      ValMap.insert(std::make_pair(SlotValue[i], AbsState[i]));
+  }
+  return ValMap;
+}
 
 ///////////////////////////////////////////////////////////////////////////
 // Printing utililties
@@ -1904,8 +2884,10 @@ void FixpointSSI::printResultsGlobals(raw_ostream &Out){
   // Iterate over all global variables of interest defined in the module
   for (Module::global_iterator Gv = M->global_begin(), E = M->global_end(); Gv != E; ++Gv){
     if (TrackedGlobals.count(Gv)){
-      ValueState[Gv]->print(Out);
-      Out << "\n";
+      if (AbstractValue * AbsGv = Lookup(Gv, false)){
+	AbsGv->print(Out);
+	Out << "\n";
+      }
     }
   }
   Out << "\n";
@@ -1918,19 +2900,19 @@ void FixpointSSI::printResultsFunction(Function *F, raw_ostream &Out){
   Out << "                 (Only local variables are displayed) \n" ;
   Out <<"===-------------------------------------------------------------------------===\n" ;      
 
-  DenseMap<BasicBlock*, std::set<AbstractValue*> * > BlockMap;
-  sortByBasicBlock(F, ValueState, BlockMap);
+  DenseMap<BasicBlock*, std::set<AbstractValue*> * > ValuesByBlock;
+  sortByBasicBlock(F, getValMap(), ValuesByBlock);
 
   // Iterate over each basic block.
   for (Function::iterator BB = F->begin(), EE = F->end(); BB != EE; ++BB){
     DenseMap<BasicBlock*, std::set<AbstractValue*> * >::iterator 
-      It = BlockMap.find(BB);
-    if (BBExecutable.count(BB) == 0){
+      It = ValuesByBlock.find(BB);
+    if (!IsReachable(BB)){
       Out << "Block " << BB->getName() << " is unreachable\n";
       continue;
     }
     
-    if (It == BlockMap.end())
+    if (It == ValuesByBlock.end())
       Out << "Block " << BB->getName() << " {}\n";
     else{ 
       std::set<AbstractValue*> *Values = It->second;
@@ -1945,13 +2927,9 @@ void FixpointSSI::printResultsFunction(Function *F, raw_ostream &Out){
       Out << "}\n";
     }
   }
-    
-  // Boolean flags
-  // for (DenseMap<Value*,TBool*>::iterator I=TrackedCondFlags.begin(), 
-  // 	 E=TrackedCondFlags.end(); I!=E;++I){
-  //   if (VST->lookup(I->first->getName()))
-  //     Out << " " << I->first->getName() << "=" << I->second->getValue() << "; ";
-  // }
+  for (DenseMap<BasicBlock*, std::set<AbstractValue*> * >::iterator 
+	 I = ValuesByBlock.begin(), E = ValuesByBlock.end(); I != E; ++I)
+    delete I->second;
 }
 
 /// Print the results of the analysis for the whole module.
@@ -1983,22 +2961,3 @@ void printValueInfo(Value *v, Function *F){
     }
   }
 }
-
-void printUsersInst(Value *I,SmallPtrSet<BasicBlock*, 16> BBExecutable,
-		    bool OnlyExecutable){ 
-  dbgs() << "USERS of" << *I << ": \n";
-  for (Value::use_iterator UI = I->use_begin(), E = I->use_end();
-       UI != E; ++UI) {
-    Instruction *U = cast<Instruction>(*UI);
-    if (OnlyExecutable){
-      if (BBExecutable.count(U->getParent()))       
-	dbgs() << "\t" << *U << "\n";
-    }
-    else
-      dbgs() << "\t" << *U << "\n";
-  }
-}
-   
-
-
-
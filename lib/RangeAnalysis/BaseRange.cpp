@@ -9,6 +9,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "BaseRange.h"
+#include "llvm/ADT/StringExtras.h"
 
 using namespace llvm;
 using namespace unimelb;
@@ -76,6 +77,38 @@ void BaseRange::print(raw_ostream &Out) const{
   printRange(Out);
 }
 
+/// Write the width, the bounds and the top flag in hexadecimal.
+void BaseRange::write(raw_ostream &Out) const{
+  Out << utohexstr(width) << " " 
+      << utohexstr(LB.getZExtValue()) << " " 
+      << utohexstr(UB.getZExtValue()) << " " 
+      << (__isTop ? "1" : "0");
+}
+
+/// Read what write produced. The width must be the same.
+bool BaseRange::read(StringRef &Str){
+  uint64_t W, L, U, T;
+  if (!Utilities::readHex(Str,W) || !Utilities::readHex(Str,L) ||
+      !Utilities::readHex(Str,U) || !Utilities::readHex(Str,T))
+    return false;
+  if (W != width || T > 1) 
+    return false;
+  LB = APInt(width, L);
+  UB = APInt(width, U);
+  __isTop = (T == 1);
+  return true;
+}
+
+/// Bounds for the result store (see ResultStore.h).
+bool BaseRange::getBounds(unsigned &Width, uint64_t &Lo, uint64_t &Hi) const{
+  if (width > 64) 
+    return false;
+  Width = width;
+  Lo = LB.getZExtValue();
+  Hi = UB.getZExtValue();
+  return true;
+}
+
 // Casting operations
 
 /// Check error conditions during casting operations.
@@ -151,7 +151,8 @@ Range convertTopToNumInterval(Range *Op, bool IsSigned){
 /// lessOrEqual([l1,u1],[l2,u2]) = true iff l2<=l1 and u1<=u2 
 /// (i.e., [l1,u1] is included in [l2,u2])  
 bool Range::lessOrEqual(AbstractValue* V){
-  // Simple cases first: bottom and top
+  // Simple cases first: same value, bottom and top
+  if (this == V) return true;
   if (isBot())  return true;  
   Range *I =  cast<Range>(V);    
   if (IsTop() && I->IsTop()) 
@@ -260,6 +261,8 @@ bool Range::isIdentical(AbstractValue *V){
 }
 
 bool Range::isEqual(AbstractValue *V){
+  // Constants are shared.
+  if (this == V) return true;
   Range *S = this;
   Range *T = cast<Range>(V);    
   // This is correct since we have a lattice and hence, the
@@ -443,7 +446,7 @@ void wideningJump(Range *Old, Range * New,
 
 /// Wrapper to call different widening methods.
 void Range::widening(AbstractValue *PreviousV, 
-		     const std::vector<int64_t> &JumpSet){
+		     const LandmarkSet &Landmarks){
 
   switch(WideningMethod){
   case NOWIDEN:
@@ -456,7 +459,8 @@ void Range::widening(AbstractValue *PreviousV,
   case JUMPSET:
     {
       APInt widenLB, widenUB;
-      wideningJump(cast<Range>(PreviousV), this, JumpSet, widenLB, widenUB);
+      wideningJump(cast<Range>(PreviousV), this, Landmarks.getSigned(), 
+		   widenLB, widenUB);
       // Normalization to top.
       if (IsSigned() &&
 	  (widenLB == APInt::getSignedMinValue(getWidth()) ||
@@ -863,13 +867,13 @@ void Range::filterSigma_TwoVars(unsigned Pred, Range *I1, Range *I2){
 
 /// Compute the transfer function for arithmetic binary operators and
 /// check for overflow. If overflow detected then top.
-AbstractValue* Range::
+void Range::
 visitArithBinaryOp(AbstractValue* V1, AbstractValue* V2,
 		   unsigned OpCode, const char * OpCodeName ){
   
   Range *Op1 = cast<Range>(V1);
   Range *Op2 = cast<Range>(V2);
-  Range *LHS = new Range(*this);
+  Range *LHS = this;
 
   DEBUG(dbgs() << "\t[RESULT] " 
 	<< *Op1 << " " << OpCodeName << " " << *Op2 << " = ");
@@ -888,7 +892,6 @@ visitArithBinaryOp(AbstractValue* V1, AbstractValue* V2,
 #endif 
 
   DEBUG(dbgs()<< *LHS << "\n");   
-  return LHS;
 }
 
 /// Execute an arithmetic operation but the caller will deal with
@@ -1289,7 +1292,7 @@ void Range::DoRem(bool IsSignedOp,
 
 /// Perform the transfer function for casting operations and check
 /// overflow. If overflow detected then top.
-AbstractValue * Range::
+void Range::
 visitCast(Instruction &I,  AbstractValue * V, TBool * TB, bool IsSigned){
 
   Range *RHS = NULL;    
@@ -1304,7 +1307,7 @@ visitCast(Instruction &I,  AbstractValue * V, TBool * TB, bool IsSigned){
     assert(!TB && "ERROR: some inconsistency found in visitCast");
   }
 
-  Range *LHS = new Range(*this);
+  Range *LHS = this;
   bool IsOverflow;
   DoCast(LHS,RHS,I.getOperand(0)->getType(),I.getType(),I.getOpcode(),IsOverflow);
 
@@ -1319,7 +1322,6 @@ visitCast(Instruction &I,  AbstractValue * V, TBool * TB, bool IsSigned){
   DEBUG(dbgs() << "\t[RESULT]");
   DEBUG(LHS->print(dbgs()));
   DEBUG(dbgs() << "\n");      
-  return LHS;
 
 }
 
@@ -1461,13 +1463,13 @@ DoCast(Range *LHS, Range *RHS,
 
 /// Perform the transfer function for bitwise operations and check
 /// overflow. If overflow detected then top.
-AbstractValue * Range:: 
+void Range:: 
   visitBitwiseBinaryOp(AbstractValue * V1, AbstractValue * V2, 
 		       const Type * Op1Ty, const Type * Op2Ty, 
 		       unsigned OpCode,const char * OpCodeName){
   Range *Op1 = cast<Range>(V1);
   Range *Op2 = cast<Range>(V2);
-  Range *LHS = new Range(*this);
+  Range *LHS = this;
   DEBUG(dbgs() << "\t[RESULT] ");
   DEBUG(Op1->printRange(dbgs())); 
   DEBUG(dbgs() << " " << OpCodeName << " ");
@@ -1488,7 +1490,6 @@ AbstractValue * Range::
 
   DEBUG(LHS->printRange(dbgs())); 
   DEBUG(dbgs() << "\n");        
-  return LHS;  
 }
 
 /// Perform bitwise operations.  
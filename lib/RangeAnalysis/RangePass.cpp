@@ -9,8 +9,11 @@
 
 #include "FixpointSSI.h"
 #include "Transformations/vSSA.h"
+#include "Support/Fingerprint.h"
+#include "Support/ResultCache.h"
 #include "Range.h"
 #include "WrappedRange.h"
+#include "WrappedRangeInfo.h"
 #include "llvm/Pass.h"
 #include "llvm/PassManager.h"
 #include "llvm/Module.h"
@@ -20,12 +23,15 @@
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/Dominators.h"
 #include "llvm/Analysis/CallGraph.h"
+#include "llvm/ADT/SCCIterator.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/Utils/UnifyFunctionExitNodes.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/ADT/OwningPtr.h"
 
 using namespace llvm;
 using namespace unimelb;
@@ -44,6 +50,92 @@ narrowing("narrowing",
 	  //!< User option to choose narrowing.
 	  cl::desc("Narrowing iterations (0: no narrowing)")); 
 
+cl::opt<bool> 
+useWTO("wto", 
+       cl::Hidden,
+       cl::desc("Iterate following a weak topological ordering (default = false)"),
+       //!< User option to choose the recursive iteration strategy.
+       cl::init(false)); 
+
+cl::opt<bool> 
+sparseNarrowing("sparse-narrowing", 
+		cl::Hidden,
+		cl::desc("Narrowing re-evaluates only values that may decrease (default = false)"),
+		//!< User option to choose the sparse narrowing.
+		cl::init(false)); 
+
+cl::opt<unsigned>  
+threads("threads",
+	cl::init(1),
+	cl::Hidden,
+	//!< User option to analyze several functions in parallel.
+	cl::desc("Number of functions analyzed in parallel (default = 1)")); 
+
+cl::opt<string>  
+warmStartDir("warm-start-dir",
+	     cl::init(""),
+	     cl::Hidden,
+	     //!< User option to reuse the results of a previous run.
+	     cl::desc("Directory with the snapshots of previous runs (default = none). "
+		      "A warm start only grows the saved results: an edge that "
+		      "became infeasible since the snapshot stays feasible")); 
+
+cl::opt<string>  
+resultsFile("results-file",
+	    cl::init(""),
+	    cl::Hidden,
+	    //!< User option to save the results in binary form.
+	    cl::desc("Binary file where the results are saved (default = none)")); 
+
+cl::opt<string>  
+cacheDir("cache-dir",
+	 cl::init(""),
+	 cl::Hidden,
+	 //!< User option to reuse the results of unchanged functions.
+	 cl::desc("Directory of the cache of results (default = none)")); 
+
+cl::opt<unsigned>  
+cacheSize("cache-size",
+	  cl::init(256),
+	  cl::Hidden,
+	  //!< User option to bound the size of the cache.
+	  cl::desc("Maximum size in MB of the cache of results (default = 256)")); 
+
+cl::opt<bool> 
+interprocedural("interprocedural", 
+		cl::Hidden,
+		cl::desc("Use summaries of the return values of the callees (default = false)"),
+		//!< User option to run the interprocedural analysis.
+		cl::init(false)); 
+
+cl::opt<bool> 
+propagateArgs("propagate-args", 
+	      cl::Hidden,
+	      cl::desc("Start the parameters from the values at the call sites (default = false)"),
+	      //!< User option to propagate the arguments top-down.
+	      cl::init(false)); 
+
+cl::opt<unsigned>  
+maxVisits("max-visits",
+	  cl::init(0),
+	  cl::Hidden,
+	  //!< User option to bound the work per function.
+	  cl::desc("Maximum instruction visits per function (default = 0, no limit)")); 
+
+cl::opt<unsigned>  
+maxTime("max-time",
+	cl::init(0),
+	cl::Hidden,
+	//!< User option to bound the time per function.
+	cl::desc("Maximum milliseconds per function (default = 0, no limit)")); 
+
+cl::opt<unsigned>  
+maxWidenings("max-widenings",
+	     cl::init(0),
+	     cl::Hidden,
+	     //!< User option to bound the widenings per widening point.
+	     cl::desc("Maximum widenings per widening point (default = 0, no limit)")); 
+
 cl::opt<bool> 
 enableOptimizations("enable-optimizations", 
 		    cl::Hidden,
@@ -87,6 +179,9 @@ numFuncs("numfuncs",
 // For printing analysis results
 #define PRINT_RESULTS
 
+STATISTIC(NumOfCacheHits  ,"Number of functions whose results were in the cache");
+STATISTIC(NumOfCacheMisses,"Number of functions whose results were not in the cache");
+
 namespace unimelb {
 
   /// An utility function that adds a pass to the pass manager.
@@ -224,22 +319,25 @@ namespace unimelb {
       IsSigned(isSigned){
     }
 
+    virtual const char* getAnalysisName() const { return "range"; }
+
     // Methods that allows Fixpoint creates Range objects
-    virtual AbstractValue* initAbsValBot(Value *V){
-      Range * R = new Range(V,IsSigned);
+    virtual AbstractValue* initAbsValBot(Value *V, BumpPtrAllocator *Arena){
+      Range * R = new (allocateAbsVal<Range>(Arena)) Range(V,IsSigned);
       R->makeBot();
       return R;
     }
-    virtual AbstractValue* initAbsValTop(Value *V){
-      Range * R = new Range(V,IsSigned);
+    virtual AbstractValue* initAbsValTop(Value *V, BumpPtrAllocator *Arena){
+      Range * R = new (allocateAbsVal<Range>(Arena)) Range(V,IsSigned);
       return R;
     }
     virtual AbstractValue* initAbsIntConstant(ConstantInt *C){
       Range * R = new Range(C, C->getBitWidth(),IsSigned);
       return R;
     }
-    virtual AbstractValue* initAbsValIntConstant(Value *V, ConstantInt *C){
-      Range * RV = new Range(V,IsSigned);
+    virtual AbstractValue* initAbsValIntConstant(Value *V, ConstantInt *C, 
+						 BumpPtrAllocator *Arena){
+      Range * RV = new (allocateAbsVal<Range>(Arena)) Range(V,IsSigned);
       Range RC(C, C->getBitWidth(), IsSigned);
       RV->makeBot();
       RV->join(&RC);      
@@ -256,22 +354,25 @@ namespace unimelb {
 			 AliasAnalysis *AA): 
       FixpointSSI(M,WL,NL,AA,LEX_LESS_THAN){}
 
+    virtual const char* getAnalysisName() const { return "wrapped-range"; }
+
     // Methods that allows Fixpoint creates Range objects
-    virtual AbstractValue* initAbsValBot(Value *V){
-      WrappedRange * R = new WrappedRange(V);
+    virtual AbstractValue* initAbsValBot(Value *V, BumpPtrAllocator *Arena){
+      WrappedRange * R = new (allocateAbsVal<WrappedRange>(Arena)) WrappedRange(V);
       R->makeBot();
       return R;
     }
-    virtual AbstractValue* initAbsValTop(Value *V){
-      WrappedRange * R = new WrappedRange(V);
+    virtual AbstractValue* initAbsValTop(Value *V, BumpPtrAllocator *Arena){
+      WrappedRange * R = new (allocateAbsVal<WrappedRange>(Arena)) WrappedRange(V);
       return R;
     }
     virtual AbstractValue* initAbsIntConstant(ConstantInt *C){
       WrappedRange * R = new WrappedRange(C, C->getBitWidth());
       return R;
     }
-    virtual AbstractValue* initAbsValIntConstant(Value *V, ConstantInt *C){
-      WrappedRange * RV = new WrappedRange(V);
+    virtual AbstractValue* initAbsValIntConstant(Value *V, ConstantInt *C, 
+						 BumpPtrAllocator *Arena){
+      WrappedRange * RV = new (allocateAbsVal<WrappedRange>(Arena)) WrappedRange(V);
       WrappedRange RC(C, C->getBitWidth());
       assert(RV);
       RV->makeBot();
@@ -296,6 +397,54 @@ namespace unimelb {
       return true;
   }
 
+  /// Set the options of the fixpoint chosen by the user.
+  inline void configureAnalysis(FixpointSSI &a){
+    if (useWTO)
+      a.setIterationStrategy(WTO_RECURSIVE);
+    if (sparseNarrowing)
+      a.setSparseNarrowing(true);
+    if (warmStartDir != "")
+      a.setWarmStartDir(warmStartDir);
+    a.setBudgets(maxVisits, maxTime, maxWidenings);
+  }
+
+  /// Return the pass that implements the alias analysis used by P.
+  inline Pass* getAliasAnalysisPass(Pass *P){
+    return P->getResolver()->findImplPass(&AliasAnalysis::ID);
+  }
+
+  /// Create an instance of the analysis for M with the options chosen
+  /// by the user (see configureAnalysis).
+  template<typename Analysis>
+  Analysis* createAnalysis(Module *M, AliasAnalysis *AA);
+
+  template<>
+  RangeAnalysis* createAnalysis<RangeAnalysis>(Module *M, AliasAnalysis *AA){
+    RangeAnalysis *a = new RangeAnalysis(M, widening, narrowing, AA, 
+					 SIGNED_RANGE_ANALYSIS);
+    configureAnalysis(*a);
+    return a;
+  }
+
+  template<>
+  WrappedRangeAnalysis* createAnalysis<WrappedRangeAnalysis>(Module *M, 
+							     AliasAnalysis *AA){
+    WrappedRangeAnalysis *a = new WrappedRangeAnalysis(M, widening, narrowing, AA);
+    configureAnalysis(*a);
+    return a;
+  }
+
+  /// Create an instance of the analysis for another thread. The
+  /// analysis cannot be copied so the worker is a new instance that
+  /// shares the summaries and the result store of a.
+  template<typename Analysis>
+  Analysis* createWorker(const Analysis &a){
+    Analysis *w = createAnalysis<Analysis>(a.getModule(), a.getAliasAnalysis());
+    w->setSummaries(a.getSummaries());
+    w->setResultStore(a.getResultStore());
+    return w;
+  }
+
   /// Common analyses needed by the range analysis.
   inline void RangePassRequirements(AnalysisUsage& AU){
     AU.addRequired<AliasAnalysis>();
@@ -304,38 +453,532 @@ namespace unimelb {
     AU.setPreservesAll(); // Does not transform code
   }    
 
+  /// Number of instructions of F.
+  unsigned getFunctionSize(Function *F){
+    unsigned Size=0;
+    for (Function::iterator B = F->begin(), E = F->end(); B != E; ++B)
+      Size += B->size();
+    return Size;
+  }
+
+  /// Hash of what the results of a function depend on besides its
+  /// own IR: the analysis and its options, the alias analysis, the
+  /// global variables and the declarations of the external functions.
+  Fingerprint getCacheSeed(Module &M, const char *AnalysisName, 
+			   const char *AliasAnalysisName){
+    std::string S;
+    raw_string_ostream Out(S);
+    Out << AnalysisName << " alias " << AliasAnalysisName
+	<< " widening " << widening << " narrowing " << narrowing 
+	<< " wto " << (useWTO ? 1 : 0) 
+	<< " sparse-narrowing " << (sparseNarrowing ? 1 : 0)
+	<< " max-visits " << maxVisits << " max-widenings " << maxWidenings << "\n";
+    for (Module::global_iterator G = M.global_begin(), E = M.global_end(); G != E; ++G)
+      Out << *G << "\n";
+    for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F){
+      if (F->isDeclaration()) Out << *F;
+    }
+    Out.flush();
+    Fingerprint FP;
+    FP.add(S);
+    return FP;
+  }
+
+  /// Key of F in the cache of results: Seed (see getCacheSeed) and
+  /// the IR of F after the transformations.
+  Fingerprint getCacheKey(Fingerprint Seed, Function *F){
+    std::string IR;
+    raw_string_ostream Out(IR);
+    F->print(Out);
+    Out.flush();
+    Seed.add(IR);
+    return Seed;
+  }
+
+  /// Analyze F and print its results in Out. If Cache is not NULL
+  /// and has an entry for Key then the results are taken from it
+  /// rather than computed, otherwise they are added to it.
+  ///
+  /// An entry has the size of the printed results in hexadecimal, a
+  /// newline, the printed results and, if the analysis has a result
+  /// store, the results of F in the store (see
+  /// ResultStoreWriter::encode). An entry without them is a miss.
   template<typename Analysis>
-  void runAnalysis(Module &M, CallGraph *CG, Analysis a){
-    if (runOnlyFunction != ""){
-      Function *F = M.getFunction(runOnlyFunction); 
-      if (!F){ 
-	dbgs() << "ERROR: function " << runOnlyFunction << " not found\n\n";
+  void analyzeFunction(Analysis &a, Function *F, 
+		       ResultCache *Cache, const Fingerprint &Key, 
+		       raw_ostream &Out){
+    ResultStoreWriter *Store = a.getResultStore();
+    std::string Entry;
+    if (Cache && Cache->lookup(Key.get(), Key.getCheck(), Entry)){
+      std::pair<StringRef,StringRef> P = StringRef(Entry).split('\n');
+      uint64_t Size;
+      if (Utilities::readHex(P.first, Size) && Size <= P.second.size() &&
+	  (!Store || Store->decode(F, P.second.substr(Size)))){
+	NumOfCacheHits++;
+#ifdef  PRINT_RESULTS 	  
+	Out << P.second.substr(0, Size);
+#endif 
 	return;
       }
-      a.init(F);
-      a.solve(F);
+    }
+    DEBUG(dbgs() << "------------------------------------------------------------------------\n");
+    a.init(F);
+    a.solve(F);
+    if (!Cache){
 #ifdef  PRINT_RESULTS 	  
-      a.printResultsFunction(F,dbgs());
+      a.printResultsFunction(F,Out);
 #endif 
+      return;
     }
-      else{
-	int k=0;
-	for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F){	  
-	  if (IsAnalyzable(F,*CG)){
-	    if ( (numFuncs > 0) && (k > numFuncs)) 
-	      break;
+    NumOfCacheMisses++;
+    std::string Printed;
+    raw_string_ostream PrintedOut(Printed);
+    a.printResultsFunction(F,PrintedOut);
+    PrintedOut.flush();
+#ifdef  PRINT_RESULTS 	  
+    Out << Printed;
+#endif 
+    Entry.clear();
+    raw_string_ostream EntryOut(Entry);
+    EntryOut << utohexstr(Printed.size()) << "\n" << Printed;
+    if (Store) Store->encode(F, EntryOut);
+    EntryOut.flush();
+    Cache->store(Key.get(), Key.getCheck(), Entry);
+  }
+
+  /// Run Tasks on the threads of Pool. Once they finished their
+  /// transfer caches are reused by the threads of the next run.
+  void runPool(WorkStealingPool &Pool, const std::vector<unsigned> &Tasks,
+	       WorkStealingPool::TaskFn Fn, void *Data){
+    Pool.run(Tasks, Fn, Data);
+    WrappedRange::recycleTransferCaches();
+  }
+
+  /// Order tasks by decreasing size of their functions.
+  struct LargerFunctionFirst {
+    LargerFunctionFirst(const std::vector<unsigned> &_Sizes): Sizes(_Sizes){}
+    bool operator()(unsigned T1, unsigned T2) const {
+      return Sizes[T1] > Sizes[T2];
+    }
+    const std::vector<unsigned> &Sizes;
+  };
+
+  /// State shared by the threads of runAnalysisInParallel.
+  template<typename Analysis>
+  struct ParallelAnalysisTy {
+    std::vector<Function*> Functions;
+    /// One instance of the analysis per thread.
+    std::vector<Analysis*> Workers;
+    /// Printed results of each function.
+    std::vector<std::string> Results;
+    /// Cache of results (or NULL) and key of each function.
+    ResultCache *Cache;
+    std::vector<Fingerprint> Keys;
+  };
+
+  template<typename Analysis>
+  void analyzeFunctionTask(unsigned Task, unsigned Worker, void *Data){
+    ParallelAnalysisTy<Analysis> *P = static_cast<ParallelAnalysisTy<Analysis>*>(Data);
+    Function *F = P->Functions[Task];
+    Analysis *a = P->Workers[Worker];
+    raw_string_ostream Out(P->Results[Task]);
+    analyzeFunction(*a, F, P->Cache, 
+		    P->Cache ? P->Keys[Task] : Fingerprint(), Out);
+    Out.flush();
+  }
 
-	    DEBUG(dbgs() << "------------------------------------------------------------------------\n");
-	    a.init(F);
-	    a.solve(F);
+  /// Analyze the functions Fs using a work-stealing pool of threads.
+  /// Each thread has its own instance of the analysis configured as
+  /// a (see createWorker). The largest functions are scheduled
+  /// first and the results are printed in the order of Fs so the
+  /// output does not depend on the number of threads. Statistics are
+  /// updated atomically by LLVM. The keys of the cache of results
+  /// (see analyzeFunction) are computed before starting the threads.
+  template<typename Analysis>
+  void runAnalysisInParallel(const std::vector<Function*> &Fs, 
+			     const Analysis &a, unsigned NumThreads,
+			     ResultCache *Cache, const Fingerprint &Seed){
+    ParallelAnalysisTy<Analysis> P;
+    P.Functions = Fs;
+    P.Results.resize(Fs.size());
+    P.Cache = Cache;
+    if (Cache){
+      for (unsigned i=0, e=Fs.size(); i < e; i++)
+	P.Keys.push_back(getCacheKey(Seed, Fs[i]));
+    }
+    std::vector<unsigned> Sizes, Tasks;
+    for (unsigned i=0, e=Fs.size(); i < e; i++){
+      Sizes.push_back(getFunctionSize(Fs[i]));
+      Tasks.push_back(i);
+    }
+    std::stable_sort(Tasks.begin(), Tasks.end(), LargerFunctionFirst(Sizes));
+
+    WorkStealingPool Pool(NumThreads);
+    for (unsigned i=0; i < Pool.getNumThreads(); i++)
+      P.Workers.push_back(createWorker(a));
+    // Make the locks of LLVM (e.g., those that register statistics)
+    // effective.
+    if (NumThreads > 1)
+      llvm_start_multithreaded();
+    runPool(Pool, Tasks, analyzeFunctionTask<Analysis>, &P);
+    if (NumThreads > 1)
+      llvm_stop_multithreaded();
+    for (unsigned i=0; i < P.Workers.size(); i++)
+      delete P.Workers[i];
 #ifdef  PRINT_RESULTS 	  
-	    //a.printResultsGlobals(dbgs());
-	    a.printResultsFunction(F,dbgs());
+    for (unsigned i=0, e=P.Results.size(); i < e; i++)
+      dbgs() << P.Results[i];
 #endif 
-	    k++;
+  }
+
+  /// Select the functions to be analyzed. IsAnalyzable may modify the
+  /// IR so this must be done before starting any thread.
+  void selectFunctions(Module &M, CallGraph *CG, std::vector<Function*> &Fs){
+    int k=0;
+    for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F){	  
+      if (IsAnalyzable(F,*CG)){
+	if ( (numFuncs > 0) && (k > numFuncs)) 
+	  break;
+	Fs.push_back(F);
+	k++;
+      }
+    }
+  }
+
+  /// Bottom-up schedule of the SCCs of the call graph restricted to
+  /// the selected functions.
+  struct SCCScheduleTy {
+    /// Functions of each SCC. Callees go before their callers.
+    std::vector<std::vector<Function*> > SCCs;
+    /// Whether each SCC is recursive.
+    std::vector<bool> Recursive;
+    /// 0 if the SCC does not call other SCCs. Otherwise, 1 + the
+    /// maximum level of the SCCs it calls. SCCs with the same level
+    /// do not call each other.
+    std::vector<unsigned> Level;
+    /// Other SCCs called by each SCC.
+    std::vector<std::vector<unsigned> > Callees;
+  };
+
+  void computeSCCSchedule(CallGraph *CG, const std::vector<Function*> &Fs,
+			  SCCScheduleTy &S){
+    SmallPtrSet<Function*,64> Selected(Fs.begin(), Fs.end());
+    DenseMap<Function*,unsigned> SCCOf;
+    for (scc_iterator<CallGraph*> I = scc_begin(CG), E = scc_end(CG); I != E; ++I){
+      std::vector<CallGraphNode*> &Nodes = *I;
+      unsigned Id = S.SCCs.size();
+      std::vector<Function*> SCC;
+      for (unsigned i=0, e=Nodes.size(); i < e; i++){
+	Function *F = Nodes[i]->getFunction();
+	if (F && Selected.count(F)){
+	  SCC.push_back(F);
+	  SCCOf[F] = Id;
+	}
+      }
+      if (SCC.empty()) continue;
+      unsigned Level = 0;
+      std::vector<unsigned> Callees;
+      for (unsigned i=0, e=Nodes.size(); i < e; i++){
+	for (CallGraphNode::iterator 
+	       C = Nodes[i]->begin(), CE = Nodes[i]->end(); C != CE; ++C){
+	  DenseMap<Function*,unsigned>::iterator It = 
+	    SCCOf.find(C->second->getFunction());
+	  if (It != SCCOf.end() && It->second != Id){
+	    Level = std::max(Level, S.Level[It->second] + 1);
+	    Callees.push_back(It->second);
 	  }
 	}
       }
+      std::sort(Callees.begin(), Callees.end());
+      Callees.erase(std::unique(Callees.begin(), Callees.end()), Callees.end());
+      S.SCCs.push_back(SCC);
+      S.Recursive.push_back(I.hasLoop());
+      S.Level.push_back(Level);
+      S.Callees.push_back(Callees);
+    }
+  }
+
+  /// Top-down levels of the SCCs of S: 0 if no other SCC calls it.
+  /// Otherwise, 1 + the maximum level of its callers. Callers go
+  /// after their callees in S so they are visited backwards.
+  void computeTopDownLevels(const SCCScheduleTy &S, std::vector<unsigned> &Level){
+    Level.assign(S.SCCs.size(), 0);
+    for (unsigned i=S.SCCs.size(); i-- > 0; ){
+      for (unsigned j=0, je=S.Callees[i].size(); j < je; j++){
+	unsigned C = S.Callees[i][j];
+	Level[C] = std::max(Level[C], Level[i] + 1);
+      }
+    }
+  }
+
+  /// The parameters of F can start from the values at its call sites
+  /// only if all of them are analyzed: F is local to the module, its
+  /// address is not taken and all its callers are in Fs.
+  void computeKnownArgs(const std::vector<Function*> &Fs, SummaryTable &Summaries){
+    SmallPtrSet<Function*,64> Selected(Fs.begin(), Fs.end());
+    for (unsigned i=0, e=Fs.size(); i < e; i++){
+      Function *F = Fs[i];
+      SummaryTable::Entry *E = Summaries.lookup(F);
+      if (!E || !F->hasLocalLinkage() || F->isVarArg() || F->hasAddressTaken())
+	continue;
+      bool Known = true;
+      for (Value::use_iterator U = F->use_begin(), UE = F->use_end(); U != UE; ++U){
+	CallInst *CI = dyn_cast<CallInst>(*U);
+	if (!CI || CI->getCalledFunction() != F || 
+	    !Selected.count(CI->getParent()->getParent())){
+	  Known = false;
+	  break;
+	}
+      }
+      E->ArgsKnown = Known;
+    }
+  }
+
+  /// Number of rounds over a recursive SCC after which the summaries
+  /// that still change go to top.
+  const unsigned SummaryWideningRounds = 3;
+
+  /// Analyze the functions Fs of an SCC and update their
+  /// summaries. If the SCC is recursive the summaries start from
+  /// bottom and the functions are analyzed again until no summary
+  /// changes. If Results is not NULL then the results of the last
+  /// analysis of Fs[i] are printed in (*Results)[i].
+  template<typename Analysis>
+  void analyzeSCC(Analysis &a, const std::vector<Function*> &Fs, bool Recursive,
+		  std::vector<std::string> *Results){
+    bool Changed = true;
+    for (unsigned Round=1; Changed; Round++){
+      Changed = false;
+      for (unsigned i=0, e=Fs.size(); i < e; i++){
+	DEBUG(dbgs() << "------------------------------------------------------------------------\n");
+	a.init(Fs[i]);
+	a.solve(Fs[i]);
+	Changed |= a.updateReturnSummary(Fs[i], Round > SummaryWideningRounds);
+#ifdef  PRINT_RESULTS 	  
+	if (Results){
+	  (*Results)[i].clear();
+	  raw_string_ostream Out((*Results)[i]);
+	  a.printResultsFunction(Fs[i],Out);
+	  Out.flush();
+	}
+#endif 
+      }
+      if (!Recursive) break;
+    }
+  }
+
+  /// Analyze the functions Fs of an SCC, whose callers have been
+  /// analyzed already, and add the parameters of their calls to the
+  /// call sites of the callees. If the SCC is recursive the functions
+  /// are analyzed again until no call site changes. If Results is not
+  /// NULL then the results of the last analysis of Fs[i] are printed
+  /// in (*Results)[i].
+  template<typename Analysis>
+  void analyzeSCCTopDown(Analysis &a, const std::vector<Function*> &Fs, 
+			 bool Recursive, std::vector<std::string> *Results){
+    bool Changed = true;
+    for (unsigned Round=1; Changed; Round++){
+      Changed = false;
+      for (unsigned i=0, e=Fs.size(); i < e; i++){
+	DEBUG(dbgs() << "------------------------------------------------------------------------\n");
+	a.init(Fs[i]);
+	a.solve(Fs[i]);
+	Changed |= a.updateCallSiteArgs(Fs[i], Round > SummaryWideningRounds);
+#ifdef  PRINT_RESULTS 	  
+	if (Results){
+	  (*Results)[i].clear();
+	  raw_string_ostream Out((*Results)[i]);
+	  a.printResultsFunction(Fs[i],Out);
+	  Out.flush();
+	}
+#endif 
+      }
+      if (!Recursive) break;
+    }
+  }
+
+  /// State shared by the threads of runInterproceduralAnalysis.
+  template<typename Analysis>
+  struct InterproceduralAnalysisTy {
+    SCCScheduleTy Schedule;
+    /// Whether the SCCs are analyzed top-down to propagate the
+    /// parameters or bottom-up to compute the summaries.
+    bool TopDown;
+    /// Whether the results of the current pass are printed.
+    bool PrintResults;
+    /// One instance of the analysis per thread.
+    std::vector<Analysis*> Workers;
+    /// Printed results of each function of each SCC.
+    std::vector<std::vector<std::string> > Results;
+  };
+
+  template<typename Analysis>
+  void analyzeSCCTask(unsigned Task, unsigned Worker, void *Data){
+    InterproceduralAnalysisTy<Analysis> *P = 
+      static_cast<InterproceduralAnalysisTy<Analysis>*>(Data);
+    std::vector<std::string> *Results = 
+      P->PrintResults ? &P->Results[Task] : NULL;
+    if (P->TopDown)
+      analyzeSCCTopDown(*P->Workers[Worker], P->Schedule.SCCs[Task], 
+			P->Schedule.Recursive[Task], Results);
+    else
+      analyzeSCC(*P->Workers[Worker], P->Schedule.SCCs[Task], 
+		 P->Schedule.Recursive[Task], Results);
+  }
+
+  /// Group the SCCs by level. SCCs of the same level are sorted by
+  /// decreasing size.
+  void groupByLevel(const std::vector<unsigned> &Level, 
+		    const std::vector<unsigned> &Sizes,
+		    std::vector<std::vector<unsigned> > &Levels){
+    Levels.clear();
+    for (unsigned i=0, e=Level.size(); i < e; i++){
+      if (Level[i] >= Levels.size())
+	Levels.resize(Level[i]+1);
+      Levels[Level[i]].push_back(i);
+    }
+    for (unsigned l=0, e=Levels.size(); l < e; l++)
+      std::stable_sort(Levels[l].begin(), Levels[l].end(), LargerFunctionFirst(Sizes));
+  }
+
+  /// Analyze the selected functions bottom-up over the SCCs of the
+  /// call graph so that calls use the summaries of their callees. The
+  /// SCCs of the same level are analyzed in parallel. The pool joins
+  /// its threads before the next level starts so the summaries of a
+  /// level are visible to the next one. Results are printed in the
+  /// order of the module.
+  ///
+  /// If PropagateArgs then the summaries are followed by a top-down
+  /// pass where the parameters of the functions whose callers are
+  /// all known start from the values at their call sites, and the
+  /// results are those of this pass.
+  template<typename Analysis>
+  void runInterproceduralAnalysis(Module &M, CallGraph *CG, Analysis &a, 
+				  unsigned NumThreads, bool PropagateArgs){
+    std::vector<Function*> Fs;
+    selectFunctions(M, CG, Fs);
+    SummaryTable Summaries;
+    for (unsigned i=0, e=Fs.size(); i < e; i++)
+      Summaries.add(Fs[i]);
+    a.setSummaries(&Summaries);
+
+    InterproceduralAnalysisTy<Analysis> P;
+    computeSCCSchedule(CG, Fs, P.Schedule);
+    const SCCScheduleTy &S = P.Schedule;
+    P.Results.resize(S.SCCs.size());
+    std::vector<unsigned> Sizes;
+    for (unsigned i=0, e=S.SCCs.size(); i < e; i++){
+      P.Results[i].resize(S.SCCs[i].size());
+      unsigned Size=0;
+      for (unsigned j=0, je=S.SCCs[i].size(); j < je; j++)
+	Size += getFunctionSize(S.SCCs[i][j]);
+      Sizes.push_back(Size);
+    }
+    std::vector<std::vector<unsigned> > Levels;
+    groupByLevel(S.Level, Sizes, Levels);
+
+    WorkStealingPool Pool(NumThreads);
+    for (unsigned i=0; i < Pool.getNumThreads(); i++)
+      P.Workers.push_back(createWorker(a));
+    if (NumThreads > 1)
+      llvm_start_multithreaded();
+    P.TopDown = false;
+    P.PrintResults = !PropagateArgs;
+    for (unsigned l=0, e=Levels.size(); l < e; l++)
+      runPool(Pool, Levels[l], analyzeSCCTask<Analysis>, &P);
+    if (PropagateArgs){
+      // The parameters of a level depend only on the previous levels.
+      computeKnownArgs(Fs, Summaries);
+      std::vector<unsigned> TopDownLevel;
+      computeTopDownLevels(S, TopDownLevel);
+      groupByLevel(TopDownLevel, Sizes, Levels);
+      P.TopDown = true;
+      P.PrintResults = true;
+      for (unsigned l=0, e=Levels.size(); l < e; l++)
+	runPool(Pool, Levels[l], analyzeSCCTask<Analysis>, &P);
+    }
+    if (NumThreads > 1)
+      llvm_stop_multithreaded();
+    for (unsigned i=0; i < P.Workers.size(); i++)
+      delete P.Workers[i];
+    a.setSummaries(NULL);
+#ifdef  PRINT_RESULTS 	  
+    DenseMap<Function*,std::string*> ResultOf;
+    for (unsigned i=0, e=S.SCCs.size(); i < e; i++){
+      for (unsigned j=0, je=S.SCCs[i].size(); j < je; j++)
+	ResultOf[S.SCCs[i][j]] = &P.Results[i][j];
+    }
+    for (unsigned i=0, e=Fs.size(); i < e; i++)
+      dbgs() << *ResultOf[Fs[i]];
+#endif 
+  }
+
+  /// Analyze the functions chosen by the user. If Cache is not NULL
+  /// then the results of the functions whose key (see getCacheKey) is
+  /// in Cache are taken from it.
+  template<typename Analysis>
+  void runAnalysisOnFunctions(Module &M, CallGraph *CG, Analysis &a,
+			      ResultCache *Cache, const Fingerprint &Seed){
+    if (runOnlyFunction != ""){
+      Function *F = M.getFunction(runOnlyFunction); 
+      if (!F){ 
+	dbgs() << "ERROR: function " << runOnlyFunction << " not found\n\n";
+	return;
+      }
+      analyzeFunction(a, F, Cache, 
+		      Cache ? getCacheKey(Seed, F) : Fingerprint(), dbgs());
+    }
+    else if (interprocedural || propagateArgs)
+      runInterproceduralAnalysis(M, CG, a, threads, propagateArgs);
+    else{
+      // IsAnalyzable may modify the IR so we select the functions
+      // before starting the threads.
+      std::vector<Function*> Fs;
+      selectFunctions(M, CG, Fs);
+      if (threads > 1)
+	runAnalysisInParallel(Fs, a, threads, Cache, Seed);
+      else{
+	for (unsigned i=0, e=Fs.size(); i < e; i++)
+	  analyzeFunction(a, Fs[i], Cache, 
+			  Cache ? getCacheKey(Seed, Fs[i]) : Fingerprint(),
+			  dbgs());
+      }
+    }
+  }
+
+  /// Analyze the functions chosen by the user and, if asked, save
+  /// their results in the result store.
+  ///
+  /// The cache of results is not used if the results may not depend
+  /// only on the key of the function: with a time budget, with
+  /// warm-start snapshots or with summaries of other functions. The
+  /// alias analysis AAPass is part of the keys of the cache.
+  template<typename Analysis>
+  void runAnalysis(Module &M, CallGraph *CG, Pass *AAPass, Analysis &a){
+    OwningPtr<ResultStoreWriter> Store;
+    if (resultsFile != ""){
+      Store.reset(new ResultStoreWriter(&M, a.getAnalysisName()));
+      a.setResultStore(Store.get());
+    }
+    OwningPtr<ResultCache> Cache;
+    Fingerprint Seed;
+    if (cacheDir != ""){
+      if (maxTime || warmStartDir != "" || interprocedural || propagateArgs)
+	dbgs() << "Warning: -cache-dir is ignored with -max-time, -warm-start-dir, " 
+	       << "-interprocedural and -propagate-args\n";
+      else{
+	Cache.reset(new ResultCache(cacheDir, ((uint64_t) cacheSize) << 20));
+	Seed = getCacheSeed(M, a.getAnalysisName(), 
+			    AAPass ? AAPass->getPassName() : "");
+      }
+    }
+    runAnalysisOnFunctions(M, CG, a, Cache.get(), Seed);
+    a.setResultStore(NULL);
+    if (Store.get()){
+      std::string ErrorInfo;
+      if (!Store->write(resultsFile, ErrorInfo))
+	dbgs() << "Warning: cannot write " << resultsFile << ": " << ErrorInfo << "\n";
+    }
   }
 
   /// To run an intraprocedural range analysis.
@@ -350,8 +993,8 @@ namespace unimelb {
       dbgs() <<"\n===-------------------------------------------------------------------------===\n" ;  
       dbgs() << "               Range Integer Variable Analysis \n";
       dbgs() <<"===-------------------------------------------------------------------------===\n" ;      
-      RangeAnalysis a(&M, widening , narrowing , AA, SIGNED_RANGE_ANALYSIS);
-      runAnalysis(M,CG,a);
+      OwningPtr<RangeAnalysis> a(createAnalysis<RangeAnalysis>(&M, AA));
+      runAnalysis(M,CG,getAliasAnalysisPass(this),*a);
       return false;
     }
 
@@ -373,8 +1016,8 @@ namespace unimelb {
       dbgs() <<"\n===-------------------------------------------------------------------------===\n";  
       dbgs() << "               Wrapped Range Integer Variable Analysis \n";
       dbgs() <<"===-------------------------------------------------------------------------===\n";      
-      WrappedRangeAnalysis a(&M, widening , narrowing , AA);
-      runAnalysis(M,CG,a);
+      OwningPtr<WrappedRangeAnalysis> a(createAnalysis<WrappedRangeAnalysis>(&M, AA));
+      runAnalysis(M,CG,getAliasAnalysisPass(this),*a);
       return false;
     }
 
@@ -394,6 +1037,228 @@ namespace unimelb {
 					    "Fixed-Width Wrapped Integer Range Analysis",
 					    false,false);
 
+  ////////////////////////////////////////////////////////////////////
+  ///               QUERIES FROM OTHER PASSES
+  ////////////////////////////////////////////////////////////////////
+
+  bool WrappedRangeInfo::runOnModule(Module &Mod){
+    // Functions are analyzed on demand (see getInfo).
+    releaseMemory();
+    M  = &Mod;
+    AA = &getAnalysis<AliasAnalysis>();
+    return false;
+  }
+
+  void WrappedRangeInfo::getAnalysisUsage(AnalysisUsage& AU) const {
+    // The alias analysis is used after runOnModule returns.
+    AU.addRequiredTransitive<AliasAnalysis>();
+    AU.setPreservesAll(); // Does not transform code
+  }
+
+  void WrappedRangeInfo::releaseMemory(){
+    for (DenseMap<Function*,FunctionInfo*>::iterator 
+	   I = Infos.begin(), E = Infos.end(); I != E; ++I)
+      delete I->second;
+    Infos.clear();
+    delete Analysis;
+    Analysis = NULL;
+  }
+
+  void WrappedRangeInfo::forget(Function *F){
+    DenseMap<Function*,FunctionInfo*>::iterator It = Infos.find(F);
+    if (It == Infos.end()) return;
+    delete It->second;
+    Infos.erase(It);
+  }
+
+  WrappedRangeInfo::FunctionInfo* WrappedRangeInfo::getInfo(Function *F){
+    DenseMap<Function*,FunctionInfo*>::iterator It = Infos.find(F);
+    if (It != Infos.end()) 
+      return It->second;
+    FunctionInfo *Info = new FunctionInfo();
+    Infos[F] = Info;
+    if (!M || !Utilities::IsTrackableFunction(F)) 
+      return Info;
+    if (!Analysis)
+      Analysis = createAnalysis<WrappedRangeAnalysis>(M, AA);
+    DEBUG(dbgs() << "------------------------------------------------------------------------\n");
+    Analysis->init(F);
+    Analysis->solve(F);
+    Info->Analyzed = true;
+
+    std::vector<Value*> Values;
+    for (Function::arg_iterator A = F->arg_begin(), E = F->arg_end(); A != E; ++A)
+      Values.push_back(A);
+    for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I)
+      Values.push_back(&*I);
+    for (unsigned i=0, e=Values.size(); i < e; i++){
+      if (WrappedRange *R = 
+	  dyn_cast_or_null<WrappedRange>(Analysis->getAbsValue(Values[i])))
+	Info->Ranges[Values[i]] = R->clone();
+    }
+    for (Function::iterator B = F->begin(), E = F->end(); B != E; ++B){
+      if (!Analysis->IsReachable(B)) continue;
+      Info->Reachable.insert(B);
+      for (succ_iterator S = succ_begin(B), SE = succ_end(B); S != SE; ++S){
+	if (Analysis->IsEdgeFeasible(B, *S))
+	  Info->FeasibleEdges.insert(std::make_pair(&*B, *S));
+      }
+    }
+    return Info;
+  }
+
+  const WrappedRange* WrappedRangeInfo::getRange(Value *V){
+    Function *F = NULL;
+    if (Argument *A = dyn_cast<Argument>(V))
+      F = A->getParent();
+    else if (Instruction *I = dyn_cast<Instruction>(V))
+      F = I->getParent()->getParent();
+    if (!F) return NULL;
+    return getInfo(F)->Ranges.lookup(V);
+  }
+
+  bool WrappedRangeInfo::isReachable(BasicBlock *B){
+    FunctionInfo *Info = getInfo(B->getParent());
+    return (!Info->Analyzed || Info->Reachable.count(B));
+  }
+
+  bool WrappedRangeInfo::isEdgeFeasible(BasicBlock *From, BasicBlock *To){
+    FunctionInfo *Info = getInfo(From->getParent());
+    return (!Info->Analyzed || Info->FeasibleEdges.count(std::make_pair(From, To)));
+  }
+
+  void WrappedRangeInfo::print(raw_ostream &Out, const Module *) const {
+    if (!M) return;
+    // Printing analyzes the functions that were not queried yet.
+    WrappedRangeInfo *This = const_cast<WrappedRangeInfo*>(this);
+    for (Module::iterator F = M->begin(), FE = M->end(); F != FE; ++F){
+      FunctionInfo *Info = This->getInfo(F);
+      if (!Info->Analyzed) continue;
+      Out << "Function " << F->getName() << " { ";
+      for (Function::arg_iterator A = F->arg_begin(), E = F->arg_end(); A != E; ++A){
+	if (const WrappedRange *R = Info->Ranges.lookup(A)){
+	  R->print(Out);
+	  Out << "; ";
+	}
+      }
+      Out << "}\n";
+      for (Function::iterator B = F->begin(), E = F->end(); B != E; ++B){
+	if (!Info->Reachable.count(B)){
+	  Out << "  Block " << B->getName() << " is unreachable\n";
+	  continue;
+	}
+	Out << "  Block " << B->getName() << " { ";
+	for (BasicBlock::iterator I = B->begin(), IE = B->end(); I != IE; ++I){
+	  if (const WrappedRange *R = Info->Ranges.lookup(I)){
+	    R->print(Out);
+	    Out << "; ";
+	  }
+	}
+	Out << "}\n";
+      }
+    }
+  }
+
+  char WrappedRangeInfo::ID = 0;
+  static RegisterPass<WrappedRangeInfo> WRI("wrapped-range-info",
+					    "Wrapped Integer Ranges computed on demand",
+					    false,true);
+
+  /// This class reads the file written with -results-file and prints
+  /// it (with opt -analyze) in the format of -wrapped-range-info. The
+  /// IR must be the one that was analyzed since the results refer to
+  /// the positions of the functions, blocks and values.
+  class ResultsFilePrinter : public ModulePass{
+  public:
+    // Pass identification, replacement for typeid
+    static char ID;
+    /// Constructor of the class.
+    ResultsFilePrinter(): ModulePass(ID), M(NULL){}
+    /// Destructor of the class.
+    ~ResultsFilePrinter(){}
+
+    virtual bool runOnModule(Module &Mod){
+      M = &Mod;
+      std::string ErrorInfo;
+      if (!Reader.open(resultsFile, ErrorInfo)){
+	dbgs() << "ERROR: cannot read " << resultsFile << ": " << ErrorInfo << "\n";
+	M = NULL;
+      }
+      return false;
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage& AU) const {
+      AU.setPreservesAll(); // Does not transform code
+    }
+
+    virtual void print(raw_ostream &Out, const Module *) const {
+      if (!M) return;
+      unsigned Index = 0;
+      for (Module::iterator F = M->begin(), FE = M->end(); F != FE; ++F, ++Index){
+	const ResultStoreFunction *R = Reader.lookupFunction(Index);
+	if (!R) continue;
+	unsigned Key = 0;
+	Out << "Function " << F->getName() << " { ";
+	for (Function::arg_iterator A = F->arg_begin(), E = F->arg_end();
+	     A != E; ++A, ++Key)
+	  printValue(Out, A, Reader.lookupValue(R, Key));
+	Out << "}\n";
+	DenseMap<BasicBlock*,unsigned> BlockPos;
+	unsigned NumOfBlocks = 0;
+	for (Function::iterator B = F->begin(), E = F->end(); B != E; ++B)
+	  BlockPos[B] = NumOfBlocks++;
+	for (Function::iterator B = F->begin(), E = F->end(); B != E; ++B){
+	  if (!Reader.isReachable(R, BlockPos[B])){
+	    Out << "  Block " << B->getName() << " is unreachable\n";
+	    Key += B->size();
+	    continue;
+	  }
+	  Out << "  Block " << B->getName() << " { ";
+	  for (BasicBlock::iterator I = B->begin(), IE = B->end(); I != IE; ++I, ++Key)
+	    printValue(Out, I, Reader.lookupValue(R, Key));
+	  Out << "}\n";
+	  for (succ_iterator S = succ_begin(B), SE = succ_end(B); S != SE; ++S){
+	    if (Reader.isEdgeFeasible(R, BlockPos[B], BlockPos[*S]))
+	      Out << "    Edge " << B->getName() << " -> " << (*S)->getName() << "\n";
+	  }
+	}
+      }
+    }
+
+  private:
+    Module *M;
+    ResultStoreReader Reader;
+
+    /// Print V as AbstractValue::print does.
+    static void printValue(raw_ostream &Out, Value *V, const ResultStoreValue *R){
+      if (!R) return;
+      if (V->hasName()) Out << V->getName() << "=";
+      switch (R->Kind){
+      case RESULT_BOTTOM:
+	Out << "bottom";
+	break;
+      case RESULT_TOP:
+	Out << "[-oo,+oo]";
+	break;
+      case RESULT_RANGE:{
+	APInt Lo(R->Width, R->Lo), Hi(R->Width, R->Hi);
+	Out << "["
+	    << "u:" << Lo.toString(10,false) <<"|"<< "s:" << Lo.toString(10,true) << ","
+	    << "u:" << Hi.toString(10,false) <<"|"<< "s:" << Hi.toString(10,true) << "]";
+	break;
+      }
+      default:
+	TBool::fromBits(R->Lo).print(Out);
+      }
+      Out << "; ";
+    }
+  };
+
+  char ResultsFilePrinter::ID = 0;
+  static RegisterPass<ResultsFilePrinter> RFP("print-results-file",
+					      "Print the results saved with -results-file",
+					      false,true);
+
   ////////////////////////////////////////////////////////////////////
   ///               PASSES FOR PAPER EXPERIMENTS
   ////////////////////////////////////////////////////////////////////
@@ -420,6 +1285,8 @@ namespace unimelb {
 
       RangeAnalysis Unwrapped(&M, widening, narrowing, AA, SIGNED_RANGE_ANALYSIS);
       WrappedRangeAnalysis Wrapped(&M, widening, narrowing,  AA);
+      configureAnalysis(Unwrapped);
+      configureAnalysis(Wrapped);
       if (runOnlyFunction != ""){
 	Function *F = M.getFunction(runOnlyFunction); 
 	if (!F){
@@ -430,6 +1297,35 @@ namespace unimelb {
 	  runAnalyses(Unwrapped, "Range Analysis", 
 		      Wrapped  , "Wrapped Range Analysis", F);
       }
+      else if (interprocedural || propagateArgs){
+	std::vector<Function*> Fs;
+	selectFunctions(M, CG, Fs);
+	SummaryTable UnwrappedSummaries, WrappedSummaries;
+	for (unsigned i=0, e=Fs.size(); i < e; i++){
+	  UnwrappedSummaries.add(Fs[i]);
+	  WrappedSummaries.add(Fs[i]);
+	}
+	Unwrapped.setSummaries(&UnwrappedSummaries);
+	Wrapped.setSummaries(&WrappedSummaries);
+	SCCScheduleTy S;
+	computeSCCSchedule(CG, Fs, S);
+	for (unsigned i=0, e=S.SCCs.size(); i < e; i++){
+	  analyzeSCC(Unwrapped, S.SCCs[i], S.Recursive[i], NULL);
+	  analyzeSCC(Wrapped, S.SCCs[i], S.Recursive[i], NULL);
+	  if (!propagateArgs)
+	    compareAnalysesOfSCC(Unwrapped, Wrapped, S.SCCs[i]);
+	}
+	if (propagateArgs){
+	  computeKnownArgs(Fs, UnwrappedSummaries);
+	  computeKnownArgs(Fs, WrappedSummaries);
+	  // Callers go after their callees.
+	  for (unsigned i=S.SCCs.size(); i-- > 0; ){
+	    analyzeSCCTopDown(Unwrapped, S.SCCs[i], S.Recursive[i], NULL);
+	    analyzeSCCTopDown(Wrapped, S.SCCs[i], S.Recursive[i], NULL);
+	    compareAnalysesOfSCC(Unwrapped, Wrapped, S.SCCs[i]);
+	  }
+	}
+      }
       else{
 	int k =0;
 	for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F){	  
@@ -465,8 +1361,8 @@ namespace unimelb {
     unsigned NumOfTrivial;
     
     template<typename Analysis1, typename Analysis2>
-    void runAnalyses(Analysis1 a1, std::string a1_StrName,
-		     Analysis2 a2, std::string a2_StrName, Function *F){
+    void runAnalyses(Analysis1 &a1, std::string a1_StrName,
+		     Analysis2 &a2, std::string a2_StrName, Function *F){
 
 #ifdef  VERBOSE
 	dbgs() << "---------------- Function " << F->getName() << "---------------------\n";
@@ -487,6 +1383,26 @@ namespace unimelb {
 	compareAnalysesOfFunction(a1, a2);
     }
 
+    /// Compare the analyses of the functions of an SCC that has just
+    /// been analyzed.
+    void compareAnalysesOfSCC(RangeAnalysis &Unwrapped, 
+			      WrappedRangeAnalysis &Wrapped,
+			      const std::vector<Function*> &SCC){
+      if (SCC.size() == 1){
+	compareAnalysesOfFunction(Unwrapped,Wrapped);
+	return;
+      }
+      // Each analysis keeps only the state of its last function so
+      // we analyze again the others with the final summaries.
+      for (unsigned j=0, je=SCC.size(); j < je; j++){
+	Unwrapped.init(SCC[j]);
+	Unwrapped.solve(SCC[j]);
+	Wrapped.init(SCC[j]);
+	Wrapped.solve(SCC[j]);
+	compareAnalysesOfFunction(Unwrapped,Wrapped);
+      }
+    }
+
     void compareAnalysesOfFunction(const RangeAnalysis &Unwrapped,
 				   const WrappedRangeAnalysis &Wrapped){
 
@@ -681,6 +1597,8 @@ namespace unimelb {
       
       RangeAnalysis      Unwrapped(&M, widening, narrowing, AA, IsSigned);
       WrappedRangeAnalysis Wrapped(&M, widening, narrowing, AA);
+      configureAnalysis(Unwrapped);
+      configureAnalysis(Wrapped);
       IOCCounter_Unwrapped c1; IOCCounter_Wrapped c2;
 
       if (runOnlyFunction != ""){
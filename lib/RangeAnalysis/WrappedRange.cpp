@@ -11,6 +11,10 @@
 
 #include "BaseRange.h"
 #include "WrappedRange.h"
+#include "Support/Parallel.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/ThreadLocal.h"
 
 #include <algorithm>
 
@@ -39,6 +43,192 @@ void test_GeneralizedJoin();
 STATISTIC(NumOfOverflows     ,"Number of overflows");
 STATISTIC(NumOfJoins         ,"Number of joins");
 STATISTIC(NumOfJoinTies      ,"Number of join ties");
+STATISTIC(NumOfCacheLookups  ,"Number of lookups in the transfer cache");
+STATISTIC(NumOfCacheHits     ,"Number of hits in the transfer cache");
+
+namespace unimelb {
+
+  /// Number of entries of the transfer cache of each thread.
+  const unsigned TransferCacheSize = 1024;
+
+  /// Cache of the results of the transfer functions that are expensive
+  /// because they split the operands at the poles: multiplication,
+  /// division and remainder, bitwise operations and casts. The result
+  /// only depends on the opcode, the bounds and flags of the operands
+  /// and the width of the result.
+  ///
+  /// The cache is direct-mapped so its size is bounded and a new
+  /// entry simply replaces the one in its bucket. Each thread has its
+  /// own cache so no locks are needed. Only widths up to 64 bits are
+  /// cached.
+  ///
+  /// The caches are owned by TransferCachePool. The threads that
+  /// finished give their caches back (see
+  /// WrappedRange::recycleTransferCaches) so the next ones reuse them.
+  class TransferCache {
+  public:
+    struct Key {
+      unsigned OpCode;
+      unsigned Width; //!< Width of the result.
+      unsigned Width1, Width2;
+      unsigned char Flags1, Flags2;
+      uint64_t LB1, UB1, LB2, UB2;
+
+      inline bool operator==(const Key &K) const {
+	return (OpCode == K.OpCode && Width == K.Width && 
+		Width1 == K.Width1 && Width2 == K.Width2 &&
+		Flags1 == K.Flags1 && Flags2 == K.Flags2 &&
+		LB1 == K.LB1 && UB1 == K.UB1 && LB2 == K.LB2 && UB2 == K.UB2);
+      }
+      inline uint64_t hash() const {
+	uint64_t H = OpCode;
+	H = mix(H, ((uint64_t) Width << 32) | (Width1 << 16) | Width2);
+	H = mix(H, ((uint64_t) Flags1 << 8) | Flags2);
+	H = mix(H, LB1);
+	H = mix(H, UB1);
+	H = mix(H, LB2);
+	H = mix(H, UB2);
+	return H;
+      }
+      static inline uint64_t mix(uint64_t H, uint64_t V){
+	return H ^ (V + 0x9e3779b97f4a7c15ULL + (H << 6) + (H >> 2));
+      }
+    };
+
+    /// Constructor of the class.
+    TransferCache(): Entries(TransferCacheSize){}
+
+    /// Build in K the key of the operation OpCode with result width
+    /// Width and operands Op1 and Op2 (NULL for casts). Return false
+    /// if the operation cannot be cached or the calling thread has no
+    /// cache.
+    static bool makeKey(unsigned OpCode, unsigned Width, 
+			WrappedRange *Op1, WrappedRange *Op2, Key &K){
+      if (Width > 64 || Op1->getWidth() > 64 || (Op2 && Op2->getWidth() > 64))
+	return false;
+      if (!get())
+	return false;
+      K.OpCode = OpCode;
+      K.Width  = Width;
+      setOperand(Op1, K.Width1, K.Flags1, K.LB1, K.UB1);
+      if (Op2)
+	setOperand(Op2, K.Width2, K.Flags2, K.LB2, K.UB2);
+      else{
+	K.Width2 = 0; K.Flags2 = 0; K.LB2 = 0; K.UB2 = 0;
+      }
+      return true;
+    }
+
+    /// If K is in the cache then overwrite LHS with its result and
+    /// return true.
+    bool lookup(const Key &K, WrappedRange *LHS){
+      NumOfCacheLookups++;
+      Entry &E = Entries[K.hash() % TransferCacheSize];
+      if (!E.Valid || !(E.K == K))
+	return false;
+      NumOfCacheHits++;
+      LHS->setZeroAndChangeWidth(E.Width);
+      LHS->setLB(APInt(E.Width, E.LB));
+      LHS->setUB(APInt(E.Width, E.UB));
+      LHS->__isTop = (E.Flags & TopFlag);
+      LHS->__isBottom = (E.Flags & BotFlag);
+      return true;
+    }
+
+    /// Record LHS as the result of K.
+    void insert(const Key &K, WrappedRange *LHS){
+      Entry &E = Entries[K.hash() % TransferCacheSize];
+      E.Valid = true;
+      E.K = K;
+      setOperand(LHS, E.Width, E.Flags, E.LB, E.UB);
+    }
+
+    /// Cache of the calling thread (NULL if it cannot have one).
+    static TransferCache* get();
+
+  private:
+    static const unsigned char BotFlag = 1;
+    static const unsigned char TopFlag = 2;
+
+    struct Entry {
+      Entry(): Valid(false){}
+      bool Valid;
+      Key K;
+      unsigned Width;
+      unsigned char Flags;
+      uint64_t LB, UB;
+    };
+    std::vector<Entry> Entries;
+
+    static inline void setOperand(WrappedRange *R, unsigned &Width, 
+				  unsigned char &Flags, uint64_t &LB, uint64_t &UB){
+      Width = R->getWidth();
+      Flags = (R->isBot() ? BotFlag : 0) | (R->IsTop() ? TopFlag : 0);
+      LB = R->getLB().getZExtValue();
+      UB = R->getUB().getZExtValue();
+    }
+  };
+
+  /// Owner of the transfer caches of all threads. The caches are
+  /// deleted at exit.
+  class TransferCachePool {
+  public:
+    ~TransferCachePool(){
+      for (unsigned i=0, e=All.size(); i < e; i++)
+	delete All[i];
+    }
+    /// Return a free cache or a new one.
+    TransferCache* take(){
+      ScopedLock L(Lock);
+      if (Free.empty()){
+	All.push_back(new TransferCache());
+	return All.back();
+      }
+      TransferCache *C = Free.back();
+      Free.pop_back();
+      return C;
+    }
+    /// Make free all the caches except Keep.
+    void recycle(TransferCache *Keep){
+      ScopedLock L(Lock);
+      Free.clear();
+      for (unsigned i=0, e=All.size(); i < e; i++){
+	if (All[i] != Keep)
+	  Free.push_back(All[i]);
+      }
+    }
+  private:
+    Mutex Lock;
+    std::vector<TransferCache*> All;
+    std::vector<TransferCache*> Free;
+  };
+
+  static TransferCachePool TransferCaches;
+  static sys::ThreadLocal<TransferCache> ThreadTransferCache;
+#if !defined(LLVM_MULTITHREADED) || !LLVM_MULTITHREADED
+  static pthread_t MainThread = pthread_self();
+#endif
+
+  TransferCache* TransferCache::get(){
+#if !defined(LLVM_MULTITHREADED) || !LLVM_MULTITHREADED
+    // Without thread support sys::ThreadLocal is a single pointer
+    // shared by all threads so only the main thread has a cache.
+    if (!pthread_equal(MainThread, pthread_self()))
+      return NULL;
+#endif
+    TransferCache *C = ThreadTransferCache.get();
+    if (!C){
+      C = TransferCaches.take();
+      ThreadTransferCache.set(C);
+    }
+    return C;
+  }
+
+} // end namespace
+
+void WrappedRange::recycleTransferCaches(){
+  TransferCaches.recycle(ThreadTransferCache.get());
+}
 
 void printComparisonOp(unsigned Pred,raw_ostream &Out){
   switch(Pred){
@@ -79,6 +269,8 @@ bool WrappedRange::isIdentical(AbstractValue* V){
 }
 
 bool WrappedRange::isEqual(AbstractValue* V){
+  // Constants are shared.
+  if (this == V) return true;
   WrappedRange *S = this;
   WrappedRange *T = cast<WrappedRange>(V);    
   // This is correct since we have a poset and the anti-symmetric
@@ -126,41 +318,42 @@ void widenOneInterval(const APInt &a, const APInt &b, unsigned int width,
 #else
 /////
 // Optimized version that speed up the analysis significantly.
-// This version takes advantage of the fact that JumpSet is sorted.
+// The landmarks of each width are precomputed and sorted as unsigned
+// words (i.e., in lexicographical order) so we only need a binary
+// search and nothing is allocated.
 /////
-void widenOneInterval(const APInt &a, const APInt &b, unsigned int width,		      
-		      const std::vector<int64_t> &JumpSet,
+void widenOneInterval(const APInt &a, const APInt &b, unsigned int width,
+		      const LandmarkSet &JumpSet,
 		      APInt &lb, APInt &ub){
 
+  const std::vector<uint64_t> &Words = JumpSet.getWords(width);
+  if (Words.empty()){
+    lb = a;
+    ub = b;
+    return;
+  }
+
   // lb_It points to the first element that is not less than lb
-  std::vector<int64_t>::const_iterator lb_It= 
-    std::lower_bound(JumpSet.begin(), JumpSet.end(), a.getSExtValue(), 
-		     Utilities::Lex_LessThan_Comp);
+  std::vector<uint64_t>::const_iterator lb_It= 
+    std::lower_bound(Words.begin(), Words.end(), a.getZExtValue());
 
-  if (lb_It == JumpSet.end()) // no element is less than a
+  if (lb_It == Words.end()) // no element is less than a
     lb = a; 
   else{
-    if (lb_It == JumpSet.begin()){
-      APInt LB_LandMark(width, *(lb_It), false);
-      lb = LB_LandMark;
-    }
-    else{
-      APInt LB_LandMark(width, *(lb_It-1), false);
-      lb = LB_LandMark;
-    }
+    if (lb_It == Words.begin())
+      lb = APInt(width, *(lb_It), false);
+    else
+      lb = APInt(width, *(lb_It-1), false);
   }
 
   // ub_It points to the first element that is greater than ub
-  std::vector<int64_t>::const_iterator ub_It= 
-    std::upper_bound(JumpSet.begin(), JumpSet.end(), b.getSExtValue(), 
-		     Utilities::Lex_LessThan_Comp);
+  std::vector<uint64_t>::const_iterator ub_It= 
+    std::upper_bound(Words.begin(), Words.end(), b.getZExtValue());
 
-  if (ub_It == JumpSet.end()) // no element is greater than b
+  if (ub_It == Words.end()) // no element is greater than b
     ub = b; 
-  else{
-    APInt UB_LandMark(width, *ub_It, false);
-    ub = UB_LandMark;
-  }
+  else
+    ub = APInt(width, *ub_It, false);
 
 #ifdef DEBUG_WIDENING
   dbgs() << "Widen interval based on landmarks: " 
@@ -187,13 +380,14 @@ bool checkOverflowForWideningJump(const APInt &Card){
 /// doubling the size of one the intervals. We also use the constants
 /// of the program to make guesses.
 void WrappedRange::widening(AbstractValue *PreviousV, 
-                            const std::vector<int64_t> &JumpSet){
+                            const LandmarkSet &JumpSet){
 
   if (PreviousV->isBot()) return;
   // rest of trivial cases are handled by the caller (e.g., if any of
   // the two abstract values is top).
 
-  WrappedRange *Old = cast<WrappedRange>(PreviousV->clone());  
+  // Old is only read so there is no need to copy it.
+  WrappedRange *Old = cast<WrappedRange>(PreviousV);
   WrappedRange *New = this;
 
   // if (New->lessOrEqual(Old)) return;
@@ -453,6 +647,7 @@ bool WrappedRange::WrappedlessOrEqual(AbstractValue * V){
 
 
 bool WrappedRange::lessOrEqual(AbstractValue * V){ 
+  if (this == V) return true;
   return WrappedlessOrEqual(V);
 }
 
@@ -460,6 +655,24 @@ void WrappedRange::print(raw_ostream &Out) const{
     BaseRange::print(Out);
 }
 
+/// Write the bounds plus the bottom flag and the widening counter.
+void WrappedRange::write(raw_ostream &Out) const{
+  BaseRange::write(Out);
+  Out << " " << (__isBottom ? "1" : "0") 
+      << " " << utohexstr(CounterWideningCannotDoubling);
+}
+
+bool WrappedRange::read(StringRef &Str){
+  if (!BaseRange::read(Str)) 
+    return false;
+  uint64_t Bot, Counter;
+  if (!Utilities::readHex(Str,Bot) || !Utilities::readHex(Str,Counter) || Bot > 1)
+    return false;
+  __isBottom = (Bot == 1);
+  CounterWideningCannotDoubling = Counter;
+  return true;
+}
+
 void WrappedRange::join(AbstractValue *V){
   WrappedRange * R = cast<WrappedRange>(V);
   if (R->isBot()) 
@@ -2112,7 +2325,7 @@ void WrappedRange::
 
 
 /// Perform the transfer function for binary arithmetic operations.
-AbstractValue* WrappedRange::
+void WrappedRange::
 visitArithBinaryOp(AbstractValue *V1,AbstractValue *V2,
 		   unsigned OpCode, const char *OpCodeName){
 
@@ -2120,7 +2333,9 @@ visitArithBinaryOp(AbstractValue *V1,AbstractValue *V2,
   
   WrappedRange *Op1 = cast<WrappedRange>(V1);
   WrappedRange *Op2 = cast<WrappedRange>(V2);
-  WrappedRange *LHS = new WrappedRange(*this);
+  WrappedRange *LHS = this;
+  TransferCache::Key K;
+  bool Cacheable = false;
         
   DEBUG(dbgs() << "\t [RESULT] ");
   DEBUG(Op1->printRange(dbgs()));
@@ -2145,6 +2360,14 @@ visitArithBinaryOp(AbstractValue *V1,AbstractValue *V2,
   // bottom flag will turn on again.
   LHS->resetBottomFlag();
 
+  // Addition and subtraction are cheaper than a cache lookup.
+  if (OpCode != Instruction::Add && OpCode != Instruction::Sub &&
+      TransferCache::makeKey(OpCode, Op1->getWidth(), Op1, Op2, K)){
+    if (TransferCache::get()->lookup(K, LHS))
+      goto END;
+    Cacheable = true;
+  }
+
   switch (OpCode){
   case Instruction::Add:
     WrappedPlus(LHS,Op1,Op2);
@@ -2174,9 +2397,10 @@ visitArithBinaryOp(AbstractValue *V1,AbstractValue *V2,
 
  END:
   LHS->normalizeTop();
+  if (Cacheable)
+    TransferCache::get()->insert(K, LHS);
   DEBUG(LHS->printRange(dbgs())); 
   DEBUG(dbgs() << "\n");              
-  return LHS;
 }
 
 // Pre: Operand is not bottom
@@ -2210,7 +2434,7 @@ void Truncate(WrappedRange *&LHS, WrappedRange *Operand, unsigned k){
 }
  
 /// Perform the transfer function for casting operations.
-AbstractValue* WrappedRange::
+void WrappedRange::
 visitCast(Instruction &I, 
 	  AbstractValue * V, TBool *TB, bool){
 
@@ -2226,7 +2450,7 @@ visitCast(Instruction &I,
     RHS = cast<WrappedRange>(V);    
     assert(!TB && "ERROR: some inconsistency found in visitCast");
   }
-  WrappedRange *LHS = new WrappedRange(*this);
+  WrappedRange *LHS = this;
 
   // During narrowing values that were top may not be. We need to
   // reset the top flag by hand (gross!)
@@ -2246,6 +2470,18 @@ visitCast(Instruction &I,
   /// Start doing casting: change width
   LHS->setZeroAndChangeWidth(destWidth);          
 
+  TransferCache::Key K;
+  bool Cacheable = false;
+  if (V && TransferCache::makeKey(I.getOpcode(), destWidth, RHS, NULL, K)){
+    if (TransferCache::get()->lookup(K, LHS)){
+      DEBUG(dbgs() << "\t[RESULT]");
+      DEBUG(LHS->print(dbgs()));
+      DEBUG(dbgs() << "\n");      
+      return;
+    }
+    Cacheable = true;
+  }
+
   /// Simple cases first: bottom and top
   if (RHS->isBot())
     LHS->makeTop(); // be conservative
@@ -2316,10 +2552,11 @@ visitCast(Instruction &I,
   
   if (!V) delete RHS;
    LHS->normalizeTop();    
+  if (Cacheable)
+    TransferCache::get()->insert(K, LHS);
   DEBUG(dbgs() << "\t[RESULT]");
   DEBUG(LHS->print(dbgs()));
   DEBUG(dbgs() << "\n");      
-  return LHS;
 }
 
 void WrappedRange::WrappedLogicalBitwise(WrappedRange *LHS, 
@@ -2405,7 +2642,8 @@ WrappedBitwiseShifts(WrappedRange *LHS,
     if (Shift->IsConstantRange()){
       APInt k = Shift->getUB();
       unsigned NumBitsSurviveShift = k.getBitWidth() - k.getZExtValue();
-      WrappedRange *Tmp = new WrappedRange(*Operand);
+      WrappedRange Truncated(*Operand);
+      WrappedRange *Tmp = &Truncated;
       Truncate(Tmp, Operand, NumBitsSurviveShift);
       APInt a(Operand->getLB());
       APInt b(Operand->getUB());
@@ -2440,7 +2678,6 @@ WrappedBitwiseShifts(WrappedRange *LHS,
       dbgs () << "[" << LHS->getLB().toString(2,false) << "," 
 	      << LHS->getUB().toString(2,false) << "]\n";
 #endif 
-      delete Tmp;
     }
     else{
       // FIXME: NOT_IMPLEMENTED. The shift cannot be inferred as a
@@ -2530,7 +2767,7 @@ WrappedBitwiseShifts(WrappedRange *LHS,
 
 
 /// Perform the transfer function for bitwise  operations. 
-AbstractValue* WrappedRange::
+void WrappedRange::
 visitBitwiseBinaryOp(AbstractValue * V1, 
 		     AbstractValue * V2, 
 		     const Type * Op1Ty, const Type * Op2Ty, 
@@ -2538,7 +2775,7 @@ visitBitwiseBinaryOp(AbstractValue * V1,
   
   WrappedRange *Op1 = cast<WrappedRange>(V1);
   WrappedRange *Op2 = cast<WrappedRange>(V2);
-  WrappedRange *LHS = new WrappedRange(*this);
+  WrappedRange *LHS = this;
 
   // Be careful: top can be improved. Therefore, don't return directly
   // top if one of the operand is top
@@ -2551,6 +2788,17 @@ visitBitwiseBinaryOp(AbstractValue * V1,
   // flag will turn on again.
   LHS->resetBottomFlag();
 
+  TransferCache::Key K;
+  bool Cacheable = false;
+  if (TransferCache::makeKey(OpCode, Op1->getWidth(), Op1, Op2, K)){
+    if (TransferCache::get()->lookup(K, LHS)){
+      DEBUG(LHS->printRange(dbgs())); 
+      DEBUG(dbgs() << "\n");        
+      return;
+    }
+    Cacheable = true;
+  }
+
   switch(OpCode){
   case Instruction::And:
   case Instruction::Xor:
@@ -2638,9 +2886,10 @@ visitBitwiseBinaryOp(AbstractValue * V1,
   } // end switch
 
   LHS->normalizeTop();    
+  if (Cacheable)
+    TransferCache::get()->insert(K, LHS);
   DEBUG(LHS->printRange(dbgs())); 
   DEBUG(dbgs() << "\n");        
-  return LHS;  
 }
 
 
@@ -20,6 +20,9 @@ void vSSA::getAnalysisUsage(AnalysisUsage &AU) const {
 
 bool vSSA::runOnFunction(Function &F) {
 	DT_ = &getAnalysis<DominatorTree>();
+	// The pass adds instructions but no blocks so the numbers stay valid.
+	DI_.clear();
+	DI_.addTree(DT_);
 	DF_ = &getAnalysis<DominanceFrontier>();
 	
 	// Iterate over all Basic Blocks of the Function, calling the function that creates sigma functions, if needed
@@ -208,7 +211,7 @@ void vSSA::renameUsesToSigma(Value *V, PHINode *sigma)
 		BasicBlock *BB_user = usepointers[i]->getParent();
 		
 		// Check if the use is in the dominator tree of sigma(V)
-		if (DT_->dominates(BB_next, BB_user)){
+		if (DI_.dominates(BB_next, BB_user)){
 			usepointers[i]->replaceUsesOfWith(V, sigma);
 		}
 		// Check if the use is in the dominance frontier of sigma(V)
@@ -221,7 +224,7 @@ void vSSA::renameUsesToSigma(Value *V, PHINode *sigma)
 					if (operand != V)
 						continue;
 					
-					if (DT_->dominates(BB_next, phi->getIncomingBlock(i))) {
+					if (DI_.dominates(BB_next, phi->getIncomingBlock(i))) {
 						phi->setIncomingValue(i, sigma);
 					}
 				}
@@ -252,7 +255,7 @@ SmallVector<PHINode*, 25> vSSA::insertPhisForSigma(Value *V, PHINode *sigma)
 		bool condition = false;
 	
 		if (Instruction *I = dyn_cast<Instruction>(V)) {
-			condition = DT_->dominates(I->getParent(), BB_infrontier) && dominateAny(BB_infrontier, V);
+			condition = DI_.dominates(I->getParent(), BB_infrontier) && dominateAny(BB_infrontier, V);
 		}
 		else if (isa<Argument>(V)) {
 			condition = dominateAny(BB_infrontier, V);
@@ -307,7 +310,7 @@ void vSSA::insertPhisForPhi(Value *V, PHINode *phi)
 		bool condition = false;
 	
 		if (Instruction *I = dyn_cast<Instruction>(V)) {
-			condition = DT_->dominates(I->getParent(), BB_infrontier) && dominateAny(BB_infrontier, V);
+			condition = DI_.dominates(I->getParent(), BB_infrontier) && dominateAny(BB_infrontier, V);
 		}
 		else if (isa<Argument>(V)) {
 			condition = dominateAny(BB_infrontier, V);
@@ -381,7 +384,7 @@ void vSSA::renameUsesToPhi(Value *V, PHINode *phi)
 	 
 	for (i = 0; i < n; ++i) {
 		// Check if the use is in the dominator tree of vSSA_PHI
-		if (DT_->dominates(BB_parent, usepointers[i]->getParent())) {
+		if (DI_.dominates(BB_parent, usepointers[i]->getParent())) {
 			if (BB_parent != usepointers[i]->getParent()) {
 				usepointers[i]->replaceUsesOfWith(V, phi);
 				
@@ -405,7 +408,7 @@ void vSSA::renameUsesToPhi(Value *V, PHINode *phi)
 	 				if (operand != V)
 	 					continue;
 	 				
-	 				if (DT_->dominates(BB_next, phiuser->getIncomingBlock(i))) {
+	 				if (DI_.dominates(BB_next, phiuser->getIncomingBlock(i))) {
 	 					phiuser->setIncomingValue(i, phi);
 	 				}
 	 			}
@@ -431,7 +434,7 @@ void vSSA::renameUsesToPhi(Value *V, PHINode *phi)
 		 
 		for (i = 0; i < n; ++i) {
 			// Check if the use is in the dominator tree of vSSA_PHI
-			if (DT_->dominates(BB_parent, usepointers[i]->getParent())) {
+			if (DI_.dominates(BB_parent, usepointers[i]->getParent())) {
 				if (BB_parent != usepointers[i]->getParent()) {
 					usepointers[i]->replaceUsesOfWith(V, phi);
 				
@@ -455,7 +458,7 @@ void vSSA::renameUsesToPhi(Value *V, PHINode *phi)
 		 				if (operand != V)
 		 					continue;
 		 				
-		 				if (DT_->dominates(BB_next, phiuser->getIncomingBlock(i))) {
+		 				if (DI_.dominates(BB_next, phiuser->getIncomingBlock(i))) {
 		 					phiuser->setIncomingValue(i, phi);
 		 				}
 		 			}
@@ -495,7 +498,7 @@ void vSSA::insertSigmaAsOperandOfPhis(SmallVector<PHINode*, 25> &vssaphi_created
 		for (; PI != PE; ++PI) {
 			predBB = *PI;
 		
-			if (DT_->dominates(BB, predBB)/* && (vssaphi->getBasicBlockIndex(predBB) == -1)*/) {
+			if (DI_.dominates(BB, predBB)/* && (vssaphi->getBasicBlockIndex(predBB) == -1)*/) {
 				vssaphi->addIncoming(sigma, predBB);
 			}
 		}		
@@ -574,7 +577,7 @@ bool vSSA::dominateAny(BasicBlock *BB, Value *value) {
 		if (BB == BB_father && isa<PHINode>(I)) {
 			continue;
 		}
-		if (DT_->dominates(BB, BB_father)) {
+		if (DI_.dominates(BB, BB_father)) {
 			return true;
 		}
 	}
@@ -600,7 +603,7 @@ bool vSSA::dominateOrHasInFrontier(BasicBlock *BB, BasicBlock *BB_next, Value *v
 		if (BB_next == BB_father && isa<PHINode>(I))
 			continue;
 		
-		if (DT_->dominates(BB_next, BB_father))
+		if (DI_.dominates(BB_next, BB_father))
 			return true;
 		
 		//If the BB_father is in the dominance frontier of BB then we need to create a sigma in BB_next 
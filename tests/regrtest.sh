@@ -43,6 +43,34 @@ function getAndCheckStats {
     fi
 }
 
+#######################################################################
+# Usage: checkSameResults prog opts1 opts2
+#######################################################################
+# where prog is the program to analyze.
+#       opts1 and opts2 are the options of two runs of the wrapped
+#                       analysis that must compute the same intervals,
+#                       reachable blocks and feasible edges.
+#######################################################################
+function checkSameResults {
+    prog=$1
+    opts1=$2
+    opts2=$3
+    rm -f $TEST_DIR/results.bin $TEST_DIR/log.results1 $TEST_DIR/log.results2
+    $CMMD $prog -wrapped-range-analysis -widening 3 -narrowing 1 $opts1 -results-file $TEST_DIR/results.bin >& $TEST_DIR/log
+    $CMMD $prog -print-results-file -results-file $TEST_DIR/results.bin -analyze > $TEST_DIR/log.results1 2> /dev/null
+    rm -f $TEST_DIR/results.bin
+    $CMMD $prog -wrapped-range-analysis -widening 3 -narrowing 1 $opts2 -results-file $TEST_DIR/results.bin >& $TEST_DIR/log
+    $CMMD $prog -print-results-file -results-file $TEST_DIR/results.bin -analyze > $TEST_DIR/log.results2 2> /dev/null
+    if grep "Function" $TEST_DIR/log.results1 > /dev/null && 
+	diff $TEST_DIR/log.results1 $TEST_DIR/log.results2 > /dev/null; then
+	echo "test passed."
+ 	success=$[ $success + 1]	
+    else
+	echo "test failed: results with $opts2 differ from $opts1 on ${prog}."
+ 	fails=$[ $fails + 1]	
+    fi
+    rm -f $TEST_DIR/results.bin $TEST_DIR/log.results1 $TEST_DIR/log.results2
+}
 
 echo "RUNNING REGRESSION TESTS ... "
 
@@ -165,6 +193,162 @@ echo "Running t62.c"
 $CMMD $TEST_DIR/t62.c $PASS -widening 3 -narrowing 1 >& $TEST_DIR/log
 getAndCheckStats $TEST_DIR/log 0 0
 
+echo "Running t1.c (wto)"
+$CMMD $TEST_DIR/t1.c $PASS -widening 3 -narrowing 1 -wto >& $TEST_DIR/log
+getAndCheckStats $TEST_DIR/log 0 0
+# The WTO iteration must compute the same results as the worklists.
+for t in t1 t2 t9; do
+    echo "Running $t.c (wto vs worklist)"
+    checkSameResults $TEST_DIR/$t.c "" "-wto"
+done
+
+echo "Running t1.c (sparse narrowing)"
+$CMMD $TEST_DIR/t1.c $PASS -widening 3 -narrowing 1 -sparse-narrowing >& $TEST_DIR/log
+getAndCheckStats $TEST_DIR/log 0 0
+# Sparse narrowing must reach the same narrowed intervals.
+for t in t1 t9; do
+    echo "Running $t.c (sparse vs dense narrowing)"
+    checkSameResults $TEST_DIR/$t.c "" "-sparse-narrowing"
+done
+
+echo "Running t2.c (threads)"
+$CMMD $TEST_DIR/t2.c -wrapped-range-analysis -widening 3 -narrowing 1 -threads 1 >& $TEST_DIR/log
+$CMMD $TEST_DIR/t2.c -wrapped-range-analysis -widening 3 -narrowing 1 -threads 4 >& $TEST_DIR/log.threads
+if grep "Analysis Results for" $TEST_DIR/log > /dev/null && diff $TEST_DIR/log $TEST_DIR/log.threads > /dev/null; then
+    echo "test passed."
+    success=$[ $success + 1]	
+else
+    echo "test failed: results with -threads 4 differ from -threads 1."
+    fails=$[ $fails + 1]	
+fi
+rm -f $TEST_DIR/log.threads
+
+echo "Running t2.c (interprocedural)"
+$CMMD $TEST_DIR/t2.c $PASS -widening 3 -narrowing 1 -interprocedural >& $TEST_DIR/log
+getAndCheckStats $TEST_DIR/log 0 0
+# The summary of foo is k >= 100 (the argument is unknown) rather than top.
+$CMMD $TEST_DIR/t2.c -wrapped-range-analysis -widening 3 -narrowing 1 -interprocedural >& $TEST_DIR/log
+if grep "call=\[u:100|s:100,u:2147483647|s:2147483647\]" $TEST_DIR/log > /dev/null; then
+    echo "test passed."
+    success=$[ $success + 1]	
+else
+    echo "test failed: the call to foo does not use its summary."
+    fails=$[ $fails + 1]	
+fi
+
+echo "Running t2.c (propagate args)"
+$CMMD $TEST_DIR/t2.c $PASS -widening 3 -narrowing 1 -propagate-args >& $TEST_DIR/log
+getAndCheckStats $TEST_DIR/log 0 0
+echo "Running t64.c (propagate args)"
+# k starts from 0 as with -inline 300 so the loop is bounded.
+$CMMD $TEST_DIR/t64.c -wrapped-range-analysis -widening 3 -narrowing 1 -propagate-args >& $TEST_DIR/log
+if grep "k.addr.0=\[u:0|s:0,u:100|s:100\]" $TEST_DIR/log > /dev/null; then
+    echo "test passed."
+    success=$[ $success + 1]	
+else
+    echo "test failed: the parameter of foo does not start from its call site."
+    fails=$[ $fails + 1]	
+fi
+
+echo "Running t1.c (warm start)"
+rm -rf $TEST_DIR/snapshots
+$CMMD $TEST_DIR/t1.c $PASS -widening 3 -narrowing 1 -warm-start $TEST_DIR/snapshots >& $TEST_DIR/log
+$CMMD $TEST_DIR/t1.c $PASS -widening 3 -narrowing 1 -warm-start $TEST_DIR/snapshots -stats >& $TEST_DIR/log
+getAndCheckStats $TEST_DIR/log 0 0
+if grep "Number of functions started from a snapshot" $TEST_DIR/log > /dev/null; then
+    echo "test passed."
+    success=$[ $success + 1]	
+else
+    echo "test failed: the second run did not start from the snapshots."
+    fails=$[ $fails + 1]	
+fi
+rm -rf $TEST_DIR/snapshots
+
+echo "Running t1.c (warm start, wto)"
+$CMMD $TEST_DIR/t1.c $PASS -widening 3 -narrowing 1 -wto -warm-start $TEST_DIR/snapshots >& $TEST_DIR/log
+$CMMD $TEST_DIR/t1.c $PASS -widening 3 -narrowing 1 -wto -warm-start $TEST_DIR/snapshots -stats >& $TEST_DIR/log
+getAndCheckStats $TEST_DIR/log 0 0
+if grep "Number of functions started from a snapshot" $TEST_DIR/log > /dev/null &&
+   ! grep "Number of iterations over WTO components" $TEST_DIR/log > /dev/null; then
+    echo "test passed."
+    success=$[ $success + 1]	
+else
+    echo "test failed: the second run re-iterated the WTO components."
+    fails=$[ $fails + 1]	
+fi
+rm -rf $TEST_DIR/snapshots
+
+echo "Running t1.c (budget)"
+$CMMD $TEST_DIR/t1.c $PASS -widening 3 -narrowing 1 -max-visits 20 -max-widenings 1 >& $TEST_DIR/log
+getAndCheckStats $TEST_DIR/log 0 0
+if grep "Warning: analysis of foo ran out of its .* budget" $TEST_DIR/log > /dev/null; then
+    echo "test passed."
+    success=$[ $success + 1]	
+else
+    echo "test failed: foo did not run out of its budget."
+    fails=$[ $fails + 1]	
+fi
+
+echo "Running t1.c (budget, wto)"
+$CMMD $TEST_DIR/t1.c $PASS -widening 3 -narrowing 1 -wto -max-visits 20 >& $TEST_DIR/log
+getAndCheckStats $TEST_DIR/log 0 0
+if grep "Warning: analysis of foo ran out of its visits budget" $TEST_DIR/log > /dev/null; then
+    echo "test passed."
+    success=$[ $success + 1]	
+else
+    echo "test failed: foo did not run out of its visits budget under -wto."
+    fails=$[ $fails + 1]	
+fi
+
+echo "Running t1.c (results file)"
+rm -f $TEST_DIR/results.bin
+$CMMD $TEST_DIR/t1.c -wrapped-range-analysis -widening 3 -narrowing 1 -results-file $TEST_DIR/results.bin >& $TEST_DIR/log
+if [ "`head -c 7 $TEST_DIR/results.bin 2> /dev/null`" == "WRAPRES" ]; then
+    echo "test passed."
+    success=$[ $success + 1]	
+else
+    echo "test failed: no results file."
+    fails=$[ $fails + 1]	
+fi
+# Read the file back: k.0 is [0,100], every block of foo is reachable
+# and the loop is entered.
+$CMMD $TEST_DIR/t1.c -print-results-file -results-file $TEST_DIR/results.bin -analyze >& $TEST_DIR/log
+if grep "k.0=\[u:0|s:0,u:100|s:100\]" $TEST_DIR/log > /dev/null && 
+    grep "Edge entry -> while.cond" $TEST_DIR/log > /dev/null &&
+    grep "Function foo" $TEST_DIR/log > /dev/null &&
+    ! grep "is unreachable" $TEST_DIR/log > /dev/null; then
+    echo "test passed."
+    success=$[ $success + 1]	
+else
+    echo "test failed: unexpected results read from the results file."
+    fails=$[ $fails + 1]	
+fi
+rm -f $TEST_DIR/results.bin
+
+echo "Running t63.c (wrapped-range-info)"
+$CMMD $TEST_DIR/t63.c -wrapped-range-info -widening 3 -narrowing 1 -analyze >& $TEST_DIR/log
+if grep "k.0=\[u:0|s:0,u:10|s:10\]" $TEST_DIR/log > /dev/null && 
+    grep "Block if.then is unreachable" $TEST_DIR/log > /dev/null; then
+    echo "test passed."
+    success=$[ $success + 1]	
+else
+    echo "test failed: unexpected results of -wrapped-range-info."
+    fails=$[ $fails + 1]	
+fi
+
+echo "Running t1.c (cache)"
+rm -rf $TEST_DIR/cache
+$CMMD $TEST_DIR/t1.c -wrapped-range-analysis -widening 3 -narrowing 1 -cache-dir $TEST_DIR/cache >& $TEST_DIR/log
+$CMMD $TEST_DIR/t1.c -wrapped-range-analysis -widening 3 -narrowing 1 -cache-dir $TEST_DIR/cache >& $TEST_DIR/log.cached
+if diff $TEST_DIR/log $TEST_DIR/log.cached > /dev/null && ls $TEST_DIR/cache/*.res > /dev/null 2>&1; then
+    echo "test passed."
+    success=$[ $success + 1]	
+else
+    echo "test failed: cached results differ."
+    fails=$[ $fails + 1]	
+fi
+rm -rf $TEST_DIR/cache $TEST_DIR/log.cached
+
 echo "DONE. "
 
 echo "==============================================="
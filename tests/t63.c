@@ -0,0 +1,15 @@
+// test unreachable blocks
+
+int main(){
+  int k = 0;
+
+  while (k < 10){
+    k = k + 1;
+  }
+  // k=[10,10]
+  if (k > 10){
+    // unreachable
+    k = 0;
+  }
+  return k;
+}
@@ -0,0 +1,21 @@
+#include <stdio.h>
+
+// As t2.c but foo is static so that -propagate-args can start k from
+// the value at its only call site, as -inline 300 does.
+static int foo(int k) {
+  while (k < 100) {
+    int i = 0;
+    int j = k;
+    while (i < j) {
+      i = i + 1;
+      j = j - 1;
+    }
+    k = k + 1;
+    // k=[1,100]
+  }
+  return k;
+}
+
+int main(int argc, char** argv) {
+  printf("%d\n", foo(0));
+}
@@ -41,6 +41,31 @@ Pass is the pass that we want to run:
     options:
       -widening n              n is the widening threshold (0: no widening)
       -narrowing n             n is the number of narrowing iterations (0: no narrowing)
+      -wto                     iterate following a weak topological ordering of the CFG
+                               (widening only at the heads of its components).
+      -sparse-narrowing        narrowing re-evaluates only the values that may decrease
+                               and stops as soon as nothing changes.
+      -threads n               analyze n functions in parallel (results are printed
+                               in the same order as with one thread).
+      -interprocedural         analyze the functions bottom-up over the call graph so
+                               that calls use the summaries of their callees rather than
+                               top. Often an alternative to -inline.
+      -propagate-args          as -interprocedural but then the functions are analyzed
+                               again top-down and the parameters of static functions
+                               start from the values at their call sites rather than top.
+      -warm-start dir          start from the results of the previous run saved in dir
+                               and re-analyze only what changed since then. The results
+                               only grow: an edge that became infeasible stays feasible.
+      -results-file file       save the final intervals, reachable blocks and feasible
+                               edges in the binary file (see include/Support/ResultStore.h).
+      -cache-dir dir           reuse the results of the functions whose IR, globals and
+                               options did not change since they were cached in dir.
+      -cache-size mb           maximum size of the cache (default 256). The least
+                               recently used results are removed first.
+      -max-visits n            budgets per function (0: no limit): instruction visits,
+      -max-time ms             milliseconds and widenings per widening point. If one
+      -max-widenings n         runs out the remaining values go to top and a warning
+                               names the function.
       -alias                   by default, -no-aa which always return maybe. If enabled 
                                then -basic-aa and -globalsmodref-aa are run to be more 
                                precise with global variables.
@@ -62,6 +87,8 @@ Pass is the pass that we want to run:
   general options:
     -help                      print this message
     -stats                     print stats
+    -analyze                   print the results of an analysis pass (e.g., 
+                               -wrapped-range-info or -print-results-file) on stdout
     -time                      print LLVM time passes
     -dot-cfg                   print .dot file of the LLVM IR
     -debug                     print debugging messages
@@ -130,6 +157,9 @@ GENERAL_OPTS=""
 # For extra options of my passes
 MYPASS_OPTS=""
 ###############################################################
+# 1 if the output of opt is printed
+ANALYZE=0
+###############################################################
 
 # Process args
 while [ "$3" != "" ]; do
@@ -143,6 +173,11 @@ while [ "$3" != "" ]; do
 	    shift
 	    GENERAL_OPTS="$GENERAL_OPTS -aa-eval -stats "
 	    ;;
+	-analyze)
+	    shift
+	    ANALYZE=1
+	    GENERAL_OPTS="$GENERAL_OPTS -analyze "
+	    ;;
 	-dot-cfg)
 	    shift
 	    GENERAL_OPTS="$GENERAL_OPTS -dot-cfg "
@@ -171,6 +206,62 @@ while [ "$3" != "" ]; do
 	    MYPASS_OPTS="$MYPASS_OPTS -narrowing=$3"
 	    shift
 	    ;;
+	-wto)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -wto"
+	    ;;
+	-sparse-narrowing)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -sparse-narrowing"
+	    ;;
+	-threads)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -threads=$3"
+	    shift
+	    ;;
+	-interprocedural)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -interprocedural"
+	    ;;
+	-propagate-args)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -propagate-args"
+	    ;;
+	-warm-start)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -warm-start-dir=$3"
+	    shift
+	    ;;
+	-results-file)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -results-file=$3"
+	    shift
+	    ;;
+	-cache-dir)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -cache-dir=$3"
+	    shift
+	    ;;
+	-cache-size)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -cache-size=$3"
+	    shift
+	    ;;
+	-max-visits)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -max-visits=$3"
+	    shift
+	    ;;
+	-max-time)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -max-time=$3"
+	    shift
+	    ;;
+	-max-widenings)
+	    shift
+	    MYPASS_OPTS="$MYPASS_OPTS -max-widenings=$3"
+	    shift
+	    ;;
 	-enable-optimizations)
 	    shift
 	    MYPASS_OPTS="$MYPASS_OPTS -enable-optimizations"
@@ -279,7 +370,11 @@ if [ "$MYLIBRARIES" == "" ]; then
 fi
     
 if [ -e $abspath_BC ]; then	 
-    $OPT $MYLIBRARIES $PRE_MYPASS $ALIAS_OPTS $mypass $MYPASS_OPTS $GENERAL_OPTS $abspath_BC > /dev/null
+    if [ $ANALYZE -eq 1 ]; then
+	$OPT $MYLIBRARIES $PRE_MYPASS $ALIAS_OPTS $mypass $MYPASS_OPTS $GENERAL_OPTS $abspath_BC
+    else
+	$OPT $MYLIBRARIES $PRE_MYPASS $ALIAS_OPTS $mypass $MYPASS_OPTS $GENERAL_OPTS $abspath_BC > /dev/null
+    fi
 else
     echo -e "[run-llvm]: .bc file not found.\n"
     exit 2	